@@ -8,6 +8,7 @@
 #include "fhiclcpp/extended_value.h"
 #include "range/v3/view.hpp"
 
+#include <algorithm>
 #include <initializer_list>
 #include <iostream>
 #include <regex>
@@ -26,6 +27,7 @@ namespace {
   std::string const at_nil{"@nil"};
   std::string const trigger_paths_str{"trigger_paths"};
   std::string const end_paths_str{"end_paths"};
+  std::string const on_demand_str{"on_demand"};
   bool
   matches(std::string const& path_spec_str, std::string const& path_name)
   {
@@ -118,6 +120,13 @@ namespace {
     return path_name == trigger_paths_str or path_name == end_paths_str;
   }
 
+  // Sequences in the physics block that do not name paths.
+  bool
+  is_reserved_sequence(std::string const& name)
+  {
+    return is_path_selection_override(name) or name == on_demand_str;
+  }
+
   std::string
   path_selection_override(ModuleCategory const category)
   {
@@ -409,7 +418,7 @@ namespace {
     module_entries_for_path_t sorted_result;
     for (auto const& [path_name, entries] : all_paths) {
       // Skip over special path names, which are handled later.
-      if (is_path_selection_override(path_name)) {
+      if (is_reserved_sequence(path_name)) {
         continue;
       }
       std::vector<ModuleSpec> right_modules;
@@ -556,6 +565,51 @@ namespace {
     return result;
   }
 
+  // The producers listed in 'physics.on_demand' are not placed on any
+  // path.  Each is run for an event only if a module that consumes
+  // one of its products is run.
+  std::vector<std::string>
+  on_demand_modules(module_entries_for_path_t const& paths,
+                    modules_t const& modules,
+                    keytype_for_name_t const& enabled_modules)
+  {
+    std::vector<std::string> result;
+    auto const it = paths.find(on_demand_str);
+    if (it == cend(paths)) {
+      return result;
+    }
+    for (auto const& [name, action] : it->second) {
+      auto const full_module_key_it = modules.find(name);
+      if (full_module_key_it == cend(modules)) {
+        throw config_exception("The following error occurred while "
+                               "processing the 'on_demand' sequence:")
+          << "Entry with name " << name
+          << " does not have a module configuration.\n";
+      }
+      auto const type = module_type(full_module_key_it->second);
+      if (type != art::ModuleType::producer or
+          action != art::detail::FilterAction::Normal) {
+        throw config_exception("The following error occurred while "
+                               "processing the 'on_demand' sequence:")
+          << "Entry with name " << name << " cannot be run on demand.\n"
+          << "Only producers, without a '!' or '-' prefix, can be run on "
+             "demand.\n";
+      }
+      if (enabled_modules.find(name) != cend(enabled_modules)) {
+        throw config_exception("The following error occurred while "
+                               "processing the 'on_demand' sequence:")
+          << "The producer " << name
+          << " is also assigned to an enabled path.\n"
+          << "A producer can be run either on demand or on paths, but not "
+             "both.\n";
+      }
+      result.push_back(name);
+    }
+    cet::sort_all(result);
+    result.erase(std::unique(begin(result), end(result)), end(result));
+    return result;
+  }
+
   std::pair<module_entries_for_ordered_path_t, bool>
   enabled_paths(module_entries_for_path_t const& paths,
                 modules_t const& modules,
@@ -597,6 +651,12 @@ art::detail::prune_config_if_enabled(bool const prune_config,
   enabled_modules.insert(begin(end_path_enabled_modules),
                          end(end_path_enabled_modules));
 
+  auto on_demand = on_demand_modules(paths, modules, enabled_modules);
+  for (auto const& name : on_demand) {
+    enabled_modules.try_emplace(
+      name, ModuleKeyAndType{modules.at(name), art::ModuleType::producer});
+  }
+
   modules_t unused_modules;
   for (auto const& pr : modules) {
     if (enabled_modules.find(pr.first) == cend(enabled_modules)) {
@@ -608,6 +668,7 @@ art::detail::prune_config_if_enabled(bool const prune_config,
   using namespace ::ranges;
   paths.erase("trigger_paths");
   paths.erase("end_paths");
+  paths.erase(on_demand_str);
   for (auto const& spec : trigger_paths | views::keys) {
     paths.erase(spec.name);
   }
@@ -695,6 +756,7 @@ art::detail::prune_config_if_enabled(bool const prune_config,
   return EnabledModules{std::move(enabled_modules),
                         std::move(trigger_paths),
                         std::move(end_paths),
+                        std::move(on_demand),
                         trigger_paths_override,
                         end_paths_override};
 }
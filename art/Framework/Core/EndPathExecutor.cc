@@ -16,12 +16,14 @@
 #include "art/Utilities/ScheduleID.h"
 #include "art/Utilities/TaskDebugMacros.h"
 #include "art/Utilities/Transition.h"
+#include "canvas/Persistency/Provenance/EventID.h"
 #include "canvas/Utilities/Exception.h"
 #include "hep_concurrency/WaitingTask.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "range/v3/view.hpp"
 
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -211,14 +213,16 @@ namespace art {
   //
 
   void
-  EndPathExecutor::process(Transition trans, Principal& principal)
+  EndPathExecutor::process(Transition trans,
+                           Principal& principal,
+                           TransitionWorkers const which)
   {
     for (auto& worker : unique_workers(endPathInfo_)) {
       worker.reset();
     }
     try {
       if (!endPathInfo_.paths().empty()) {
-        endPathInfo_.paths().front().process(trans, principal);
+        endPathInfo_.paths().front().process(trans, principal, which);
       }
     }
     catch (cet::exception& ex) {
@@ -309,27 +313,108 @@ namespace art {
     TDEBUG_END_FUNC_SI(4, sid);
   }
 
+  class EndPathExecutor::WritesDoneTask {
+  public:
+    WritesDoneTask(EndPathExecutor* const endPathExec,
+                   EventID const& eid,
+                   bool const lastInSubRun,
+                   bool const updateRangeSets,
+                   WaitingTaskPtr const writeDoneTask)
+      : endPathExec_{endPathExec}
+      , eid_{eid}
+      , lastInSubRun_{lastInSubRun}
+      , updateRangeSets_{updateRangeSets}
+      , writeDoneTask_{writeDoneTask}
+    {}
+
+    void
+    operator()(exception_ptr const ex)
+    {
+      auto const scheduleID = endPathExec_->sc_.id();
+      TDEBUG_BEGIN_TASK_SI(4, scheduleID);
+      if (!ex && updateRangeSets_) {
+        TDEBUG_TASK_SI(5, scheduleID) << "eid: " << eid_.run() << ", "
+                                      << eid_.subRun() << ", " << eid_.event();
+        endPathExec_->runRangeSetHandler_->update(eid_, lastInSubRun_);
+        endPathExec_->subRunRangeSetHandler_->update(eid_, lastInSubRun_);
+      }
+      endPathExec_->taskGroup_.may_run(writeDoneTask_, ex);
+      TDEBUG_END_TASK_SI(4, scheduleID);
+    }
+
+  private:
+    EndPathExecutor* const endPathExec_;
+    EventID const eid_;
+    bool const lastInSubRun_;
+    bool const updateRangeSets_;
+    WaitingTaskPtr const writeDoneTask_;
+  };
+
+  void
+  EndPathExecutor::writeEvent(WaitingTaskPtr const writeDoneTask,
+                              EventPrincipal& ep)
+  {
+    pushEventWrites_(writeDoneTask, ep, true);
+  }
+
   void
-  EndPathExecutor::writeEvent(EventPrincipal& ep)
+  EndPathExecutor::writeEventInBackground(WaitingTaskPtr const writeDoneTask,
+                                          EventPrincipal& ep)
+  {
+    // The writes of successive events of this schedule may finish in
+    // any order, whereas the range-set handlers must be updated in
+    // event order.  They are therefore updated before the event is
+    // written; should the write fail, the EventProcessor ends the job
+    // rather than close a file whose range sets cover an event it
+    // lacks.
+    runRangeSetHandler_->update(ep.eventID(), ep.isLastInSubRun());
+    subRunRangeSetHandler_->update(ep.eventID(), ep.isLastInSubRun());
+    pushEventWrites_(writeDoneTask, ep, false);
+  }
+
+  void
+  EndPathExecutor::pushEventWrites_(WaitingTaskPtr const writeDoneTask,
+                                    EventPrincipal& ep,
+                                    bool const updateRangeSets)
   {
     // We don't worry about providing the sorted list of module names
     // for the end_path right now.  If users decide it is necessary to
     // know what they are, then we can provide them.
     PathContext const pc{sc_, PathContext::end_path_spec(), {}};
+    // One count for each write, plus one for ourselves so that the
+    // task also runs when there are no output workers.
+    auto writesDoneTask =
+      make_waiting_task(WritesDoneTask{this,
+                                       ep.eventID(),
+                                       ep.isLastInSubRun(),
+                                       updateRangeSets,
+                                       writeDoneTask},
+                        outputWorkers_.size() + 1);
     for (auto ow : outputWorkers_) {
-      ow->writeEvent(ep, pc);
+      ow->queueEventWrite(
+        ep, pc, [this, ow, writesDoneTask](exception_ptr const ex) {
+          if (ex) {
+            taskGroup_.may_run(writesDoneTask, ex);
+            return;
+          }
+          try {
+            // The module may only be asked about closing its file
+            // once the write (or its batch) is done.
+            recordOutputClosureRequest(ow, Granularity::Event);
+            taskGroup_.may_run(writesDoneTask);
+          }
+          catch (...) {
+            taskGroup_.may_run(writesDoneTask, current_exception());
+          }
+        });
     }
-    auto const& eid = ep.eventID();
-    bool const lastInSubRun{ep.isLastInSubRun()};
-    TDEBUG_FUNC_SI(5, sc_.id())
-      << "eid: " << eid.run() << ", " << eid.subRun() << ", " << eid.event();
-    runRangeSetHandler_->update(eid, lastInSubRun);
-    subRunRangeSetHandler_->update(eid, lastInSubRun);
+    taskGroup_.may_run(writesDoneTask);
   }
 
   bool
   EndPathExecutor::outputsToClose() const
   {
+    std::lock_guard sentry{outputWorkersMutex_};
     return !outputWorkersToClose_.empty();
   }
 
@@ -345,6 +430,7 @@ namespace art {
   EndPathExecutor::closeSomeOutputFiles()
   {
     setOutputFileStatus(OutputFileStatus::Switching);
+    std::lock_guard sentry{outputWorkersMutex_};
     for (auto ow : outputWorkersToClose_) {
       // Skip files that are already closed due to other end-path
       // executors already closing them.
@@ -359,17 +445,21 @@ namespace art {
   bool
   EndPathExecutor::outputsToOpen() const
   {
+    std::lock_guard sentry{outputWorkersMutex_};
     return !outputWorkersToOpen_.empty();
   }
 
   void
   EndPathExecutor::openSomeOutputFiles(FileBlock const& fb)
   {
-    for (auto ow : outputWorkersToOpen_) {
-      ow->openFile(fb);
+    {
+      std::lock_guard sentry{outputWorkersMutex_};
+      for (auto ow : outputWorkersToOpen_) {
+        ow->openFile(fb);
+      }
+      outputWorkersToOpen_.clear();
     }
     setOutputFileStatus(OutputFileStatus::Open);
-    outputWorkersToOpen_.clear();
   }
 
   // Note: When we are passed OutputFileStatus::Switching, we must close
@@ -395,14 +485,22 @@ namespace art {
   EndPathExecutor::recordOutputClosureRequests(Granularity const atBoundary)
   {
     for (auto ow : outputWorkers_) {
-      if (atBoundary < ow->fileGranularity()) {
-        // The boundary we are checking at is finer than the checks
-        // the output worker needs, nothing to do.
-        continue;
-      }
-      if (ow->requestsToCloseFile()) {
-        outputWorkersToClose_.insert(ow);
-      }
+      recordOutputClosureRequest(ow, atBoundary);
+    }
+  }
+
+  void
+  EndPathExecutor::recordOutputClosureRequest(OutputWorker* const ow,
+                                              Granularity const atBoundary)
+  {
+    if (atBoundary < ow->fileGranularity()) {
+      // The boundary we are checking at is finer than the checks
+      // the output worker needs, nothing to do.
+      return;
+    }
+    if (ow->requestsToCloseFile()) {
+      std::lock_guard sentry{outputWorkersMutex_};
+      outputWorkersToClose_.insert(ow);
     }
   }
 
@@ -18,6 +18,7 @@
 
 #include "art/Framework/Core/OutputFileGranularity.h"
 #include "art/Framework/Core/OutputFileStatus.h"
+#include "art/Framework/Core/TransitionWorkers.h"
 #include "art/Framework/Core/fwd.h"
 #include "art/Framework/Principal/RangeSetHandler.h"
 #include "art/Framework/Principal/fwd.h"
@@ -29,6 +30,7 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -74,7 +76,9 @@ namespace art {
     void writeSubRun(SubRunPrincipal& srp);
 
     // Process Run/SubRun
-    void process(Transition, Principal&);
+    void process(Transition,
+                 Principal&,
+                 TransitionWorkers = TransitionWorkers::All);
 
     // Process Event
     //
@@ -83,7 +87,18 @@ namespace art {
     // first-come first-served basis (FIFO).
     void process_event(hep::concurrency::WaitingTaskPtr finalizeEventTask,
                        EventPrincipal&);
-    void writeEvent(EventPrincipal&);
+    // Each output module writes the event on its own serial queue, so
+    // that different output modules write concurrently.  The given
+    // task is run once all of the writes have completed.
+    void writeEvent(hep::concurrency::WaitingTaskPtr writeDoneTask,
+                    EventPrincipal&);
+    // As writeEvent, but for an event whose schedule goes on to its
+    // next event before the writes are done.  The run and subrun
+    // range sets are updated right away, so that they still see the
+    // events of this schedule in order.
+    void writeEventInBackground(
+      hep::concurrency::WaitingTaskPtr writeDoneTask,
+      EventPrincipal&);
 
     // Output File Switching API
     //
@@ -118,6 +133,12 @@ namespace art {
 
   private:
     class PathsDoneTask;
+    class WritesDoneTask;
+
+    void recordOutputClosureRequest(OutputWorker*, Granularity);
+    void pushEventWrites_(hep::concurrency::WaitingTaskPtr writeDoneTask,
+                          EventPrincipal&,
+                          bool updateRangeSets);
 
     // Filled by ctor, const after that.
     ScheduleContext const sc_;
@@ -142,6 +163,9 @@ namespace art {
     // to populate the list, then uses the list to do closes, then uses the same
     // list to do opens, then clears the list.
     std::set<OutputWorker*> outputWorkersToClose_{};
+    // Guards the two sets above, which may be updated from the write
+    // queues of several output modules at once.
+    mutable std::mutex outputWorkersMutex_{};
   };
 } // namespace art
 
@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <mutex>
 #include <regex>
 #include <string>
 
@@ -19,18 +20,9 @@ using VCBDMP = vector<BranchDescription const*>;
 
 namespace {
 
-  // The partial_match() functions are helpers for Rule().  They
-  // ascertain matches between criterion and candidate value for
-  // components of the branch description, with appropriate wildcard
-  // rules.
-  inline bool
-  partial_match(string const& regularExpression, string const& branchstring)
-  {
-    return regularExpression.empty() ?
-             branchstring == "" :
-             std::regex_match(branchstring, std::regex(regularExpression));
-  }
-
+  // The partial_match() function is a helper for Rule().  It
+  // ascertains matches between the criterion and candidate branch
+  // type.
   inline bool
   partial_match(art::BranchType wanted, art::BranchType candidate)
   {
@@ -139,46 +131,99 @@ namespace {
 
 } // namespace
 
+// The patterns are those made by parseComponents: the only
+// characters with a special meaning are the '.' of the wildcards "*"
+// (".*") and "?" ("."), since '.' is not permitted otherwise.
+GroupSelectorRules::FieldMatcher::FieldMatcher(string const& pattern)
+{
+  auto const wildcards = count(pattern.cbegin(), pattern.cend(), '.');
+  if (pattern == ".*") {
+    kind_ = Kind::Any;
+  } else if (wildcards == 0) {
+    // Includes the empty pattern, which only matches an empty value.
+    kind_ = Kind::Exact;
+    text_ = pattern;
+  } else if (wildcards == 1 && pattern.size() > 2 &&
+             pattern.compare(pattern.size() - 2, 2, ".*") == 0) {
+    kind_ = Kind::Prefix;
+    text_ = pattern.substr(0, pattern.size() - 2);
+  } else if (wildcards == 1 && pattern.size() > 2 &&
+             pattern.compare(0, 2, ".*") == 0) {
+    kind_ = Kind::Suffix;
+    text_ = pattern.substr(2);
+  } else {
+    kind_ = Kind::Regex;
+    regex_ = std::regex(pattern);
+  }
+}
+
+bool
+GroupSelectorRules::FieldMatcher::matches(string const& value) const
+{
+  switch (kind_) {
+  case Kind::Any:
+    return true;
+  case Kind::Exact:
+    return value == text_;
+  case Kind::Prefix:
+    return value.compare(0, text_.size(), text_) == 0;
+  case Kind::Suffix:
+    return value.size() >= text_.size() &&
+           value.compare(value.size() - text_.size(), text_.size(), text_) ==
+             0;
+  case Kind::Regex:
+    return std::regex_match(value, regex_);
+  }
+  return false;
+}
+
 GroupSelectorRules::Rule::Rule(string const& s,
                                string const& parameterName,
                                string const& owner)
   : components_{parseComponents(s, parameterName, owner, selectflag_)}
+  , friendlyClassName_{components_.friendlyClassName_}
+  , moduleLabel_{components_.moduleLabel_}
+  , productInstanceName_{components_.productInstanceName_}
+  , processName_{components_.processName_}
 {}
 
-void
-GroupSelectorRules::Rule::applyToAll(
-  vector<BranchSelectState>& branchstates) const
-{
-  for (auto& state : branchstates)
-    applyToOne(state.desc, state.selectMe);
-}
-
 void
 GroupSelectorRules::applyToAll(vector<BranchSelectState>& branchstates) const
 {
-  for (auto const& rule : rules_)
-    rule.applyToAll(branchstates);
+  std::lock_guard sentry{mutex_};
+  for (auto& state : branchstates) {
+    auto& selected = selected_[state.desc->branchType()];
+    auto it = selected.find(state.desc->productID());
+    if (it == selected.cend()) {
+      it = selected.emplace(state.desc->productID(), select(state.desc)).first;
+    }
+    state.selectMe = it->second;
+  }
 }
 
-void
-GroupSelectorRules::Rule::applyToOne(BranchDescription const* branch,
-                                     bool& result) const
+// Each rule overrides all previous rules, so the last rule that
+// applies decides.  A product to which no rule applies is dropped.
+bool
+GroupSelectorRules::select(BranchDescription const* branch) const
 {
-  if (this->appliesTo(branch))
-    result = selectflag_;
+  for (auto it = rules_.crbegin(), e = rules_.crend(); it != e; ++it) {
+    if (it->appliesTo(branch)) {
+      return it->selectFlag();
+    }
+  }
+  return false;
 }
 
 bool
 GroupSelectorRules::Rule::appliesTo(BranchDescription const* branch) const
 {
-  return partial_match(components_.friendlyClassName_,
-                       branch->friendlyClassName()) &&
-         partial_match(components_.moduleLabel_, branch->moduleLabel()) &&
-         partial_match(components_.productInstanceName_,
-                       branch->productInstanceName()) &&
-         partial_match(components_.processName_, branch->processName()) &&
-         partial_match(static_cast<BranchType>(components_.branchType_),
-                       branch->branchType());
+  // The cheapest comparisons are made first.
+  return partial_match(static_cast<BranchType>(components_.branchType_),
+                       branch->branchType()) &&
+         processName_.matches(branch->processName()) &&
+         moduleLabel_.matches(branch->moduleLabel()) &&
+         productInstanceName_.matches(branch->productInstanceName()) &&
+         friendlyClassName_.matches(branch->friendlyClassName());
 }
 
 GroupSelectorRules::GroupSelectorRules(vector<string> const& commands,
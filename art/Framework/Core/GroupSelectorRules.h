@@ -5,11 +5,25 @@
 //
 // GroupSelectorRules: rules to select specific groups in an event.
 //
+// Each field of a rule is compiled once into the cheapest matcher that
+// implements it: a wildcard, an exact, prefix or suffix comparison, or
+// a regular expression as the fallback.  A product is selected by the
+// last rule that applies to it.  Since that depends only on the
+// product's branch type and name (and thus its ProductID), the answer
+// for each product is remembered, and applying the rules to the
+// products of a later input file only evaluates the new products.
+//
 // ======================================================================
 
 #include "canvas/Persistency/Provenance/BranchKey.h"
+#include "canvas/Persistency/Provenance/BranchType.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
 #include "canvas/Persistency/Provenance/fwd.h"
 
+#include <array>
+#include <map>
+#include <mutex>
+#include <regex>
 #include <string>
 #include <vector>
 
@@ -46,20 +60,32 @@ public:
   }
 
 private:
+  // Matches one component of a branch name against the (regular
+  // expression form of the) corresponding component of a rule.
+  class FieldMatcher {
+  public:
+    explicit FieldMatcher(std::string const& pattern);
+
+    bool matches(std::string const& value) const;
+
+  private:
+    enum class Kind { Any, Exact, Prefix, Suffix, Regex };
+    Kind kind_{Kind::Any};
+    std::string text_{};
+    std::regex regex_{};
+  }; // FieldMatcher
+
   class Rule {
   public:
     Rule(std::string const& s,
          std::string const& parameterName,
          std::string const& owner);
 
-    // Apply the rule to all the given branch states. This may modify
-    // the given branch states.
-    void applyToAll(std::vector<BranchSelectState>& branchstates) const;
-
-    // If this rule applies to the given BranchDescription, then
-    // modify 'result' to match the rule's select flag. If the rule does
-    // not apply, do not modify 'result'.
-    void applyToOne(BranchDescription const* branch, bool& result) const;
+    bool
+    selectFlag() const
+    {
+      return selectflag_;
+    }
 
     // Return the answer to the question: "Does the rule apply to this
     // BranchDescription?"
@@ -70,11 +96,22 @@ private:
     // bit' if this rule matches.
     bool selectflag_{false};
     BranchKey components_;
+    FieldMatcher friendlyClassName_;
+    FieldMatcher moduleLabel_;
+    FieldMatcher productInstanceName_;
+    FieldMatcher processName_;
   }; // Rule
 
-private:
+  bool select(BranchDescription const* branch) const;
+
   std::vector<Rule> rules_{};
   bool keepAll_;
+
+  // The selection of each product that the rules have been applied
+  // to, per branch type.
+  mutable std::array<std::map<ProductID, bool>, NumBranchTypes> selected_{};
+  // Protects access to selected_.
+  mutable std::mutex mutex_{};
 }; // GroupSelectorRules
 
 // ======================================================================
@@ -29,6 +29,7 @@ namespace art {
 
     void fillProductDescriptions();
     void registerProducts(ProductDescriptions& productsToRegister);
+    using ProductRegistryHelper::slotLayout;
 
   protected:
     using ProductRegistryHelper::expectedProducts;
@@ -0,0 +1,142 @@
+#include "art/Framework/Core/OnDemandWorkers.h"
+// vim: set sw=2 expandtab :
+
+#include "art/Framework/Principal/Worker.h"
+#include "art/Persistency/Provenance/ModuleDescription.h"
+#include "art/Utilities/GlobalTaskGroup.h"
+#include "art/Utilities/TaskDebugMacros.h"
+#include "hep_concurrency/WaitingTask.h"
+
+#include <cassert>
+#include <exception>
+#include <utility>
+
+using namespace hep::concurrency;
+using namespace std;
+
+namespace art {
+
+  void
+  OnDemandWorkers::add(cet::exempt_ptr<Worker> worker,
+                       PathContext const& pc,
+                       vector<size_t> prerequisites,
+                       GlobalTaskGroup& taskGroup)
+  {
+    entries_.push_back(Entry{worker,
+                             ModuleContext{pc,
+                                           worker->description(),
+                                           worker->slotLayout()},
+                             std::move(prerequisites)});
+    taskGroup_ = &taskGroup;
+  }
+
+  bool
+  OnDemandWorkers::empty() const
+  {
+    return entries_.empty();
+  }
+
+  size_t
+  OnDemandWorkers::size() const
+  {
+    return entries_.size();
+  }
+
+  void
+  OnDemandWorkers::process(Transition const trans,
+                           Principal& principal,
+                           TransitionWorkers const which)
+  {
+    // The run and subrun transitions are not done on demand: each
+    // on-demand producer sees all of them, just as if it were on a
+    // path.
+    for (auto const& entry : entries_) {
+      // We do not want to call (e.g.) beginRun once per schedule for
+      // non-replicated modules.
+      if (not entry.worker->isUnique()) {
+        continue;
+      }
+      if (which != TransitionWorkers::All) {
+        bool const replicated =
+          entry.worker->description().moduleThreadingType() ==
+          ModuleThreadingType::replicated;
+        if (replicated != (which == TransitionWorkers::Replicated)) {
+          continue;
+        }
+      }
+      entry.worker->doWork(trans, principal, entry.moduleContext);
+    }
+  }
+
+  class OnDemandWorkers::RunWorkerTask {
+  public:
+    RunWorkerTask(OnDemandWorkers* workers,
+                  size_t const idx,
+                  WaitingTaskPtr doneTask,
+                  EventPrincipal& ep)
+      : workers_{workers}
+      , idx_{idx}
+      , doneTask_{std::move(doneTask)}
+      , ep_{ep}
+    {}
+
+    void
+    operator()(exception_ptr const ex)
+    {
+      auto const& entry = workers_->entries_[idx_];
+      auto const sid = entry.moduleContext.scheduleID();
+      TDEBUG_BEGIN_TASK_SI(4, sid);
+      if (ex) {
+        // A producer this one depends on has failed.
+        workers_->taskGroup_->may_run(doneTask_, ex);
+        TDEBUG_END_TASK_SI(4, sid) << "because of EXCEPTION";
+        return;
+      }
+      workers_->runWorker(entry, doneTask_, ep_);
+      TDEBUG_END_TASK_SI(4, sid);
+    }
+
+  private:
+    OnDemandWorkers* workers_;
+    size_t const idx_;
+    WaitingTaskPtr doneTask_;
+    EventPrincipal& ep_;
+  };
+
+  void
+  OnDemandWorkers::run(size_t const idx,
+                       WaitingTaskPtr doneTask,
+                       EventPrincipal& ep)
+  {
+    assert(idx < entries_.size());
+    auto const& entry = entries_[idx];
+    if (entry.prerequisites.empty()) {
+      runWorker(entry, doneTask, ep);
+      return;
+    }
+    // The worker is started once each of its prerequisites has
+    // notified the task.
+    auto runWorkerTask =
+      make_waiting_task(RunWorkerTask{this, idx, doneTask, ep},
+                        entry.prerequisites.size());
+    for (auto const prerequisite : entry.prerequisites) {
+      run(prerequisite, runWorkerTask, ep);
+    }
+  }
+
+  void
+  OnDemandWorkers::runWorker(Entry const& entry,
+                             WaitingTaskPtr doneTask,
+                             EventPrincipal& ep)
+  {
+    // Note: If the worker has already been started for this event, the
+    // done task is only added to its list of waiting tasks.
+    try {
+      entry.worker->doWork_event(doneTask, ep, entry.moduleContext);
+    }
+    catch (...) {
+      taskGroup_->may_run(doneTask, current_exception());
+    }
+  }
+
+} // namespace art
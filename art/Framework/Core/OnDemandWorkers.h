@@ -0,0 +1,75 @@
+#ifndef art_Framework_Core_OnDemandWorkers_h
+#define art_Framework_Core_OnDemandWorkers_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// OnDemandWorkers holds, for one schedule, the workers of the
+// producers listed in the 'physics.on_demand' sequence.  These
+// producers are not on any path.  For each event, such a producer is
+// run only when a module that consumes one of its products is about
+// to run, and that module is started only once the producer has
+// finished.  No thread is therefore held up waiting for an on-demand
+// producer.
+//
+// The workers are identified by their position in the sorted list of
+// on-demand module labels.
+// ====================================================================
+
+#include "art/Framework/Core/TransitionWorkers.h"
+#include "art/Framework/Principal/fwd.h"
+#include "art/Persistency/Provenance/ModuleContext.h"
+#include "art/Utilities/Transition.h"
+#include "art/Utilities/fwd.h"
+#include "cetlib/exempt_ptr.h"
+#include "hep_concurrency/WaitingTask.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace art {
+  class OnDemandWorkers {
+  public:
+    // The prerequisites of a worker are the positions of the other
+    // on-demand workers whose products it consumes.
+    void add(cet::exempt_ptr<Worker>,
+             PathContext const&,
+             std::vector<std::size_t> prerequisites,
+             GlobalTaskGroup&);
+
+    bool empty() const;
+    std::size_t size() const;
+
+    void process(Transition,
+                 Principal&,
+                 TransitionWorkers = TransitionWorkers::All);
+
+    // Run the worker at position idx for the event, after the
+    // on-demand workers it depends on.  The worker is run at most
+    // once per event; doneTask is notified when it has finished.
+    void run(std::size_t idx,
+             hep::concurrency::WaitingTaskPtr doneTask,
+             EventPrincipal&);
+
+  private:
+    class RunWorkerTask;
+
+    struct Entry {
+      cet::exempt_ptr<Worker> worker;
+      ModuleContext moduleContext;
+      std::vector<std::size_t> prerequisites;
+    };
+
+    void runWorker(Entry const&,
+                   hep::concurrency::WaitingTaskPtr doneTask,
+                   EventPrincipal&);
+
+    std::vector<Entry> entries_{};
+    GlobalTaskGroup* taskGroup_{nullptr};
+  };
+} // namespace art
+
+#endif /* art_Framework_Core_OnDemandWorkers_h */
+
+// Local Variables:
+// mode: c++
+// End:
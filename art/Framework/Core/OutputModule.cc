@@ -35,6 +35,7 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "range/v3/view.hpp"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
@@ -63,6 +64,7 @@ namespace art {
     , configuredFileName_{config().fileName()}
     , dataTier_{config().dataTier()}
     , streamName_{config().streamName()}
+    , writeBatchSize_{std::max(config().writeBatchSize(), std::size_t{1})}
   {
     std::vector<ParameterSet> fcmdPluginPSets;
     if (config().fcmdPlugins.get_if_present(fcmdPluginPSets)) {
@@ -80,6 +82,8 @@ namespace art {
     , configuredFileName_{pset.get<string>("fileName", "")}
     , dataTier_{pset.get<string>("dataTier", "")}
     , streamName_{pset.get<string>("streamName", "")}
+    , writeBatchSize_{std::max(pset.get<std::size_t>("writeBatchSize", 1u),
+                               std::size_t{1})}
     , plugins_{makePlugins_(pset.get<vector<ParameterSet>>("FCMDPlugins", {}))}
   {
     serialize(detail::LegacyResource);
@@ -232,19 +236,49 @@ namespace art {
     auto const e = std::as_const(ep).makeEvent(mc);
     if (wantEvent(mc.scheduleID(), e)) {
       write(ep);
-      // Declare that the event was selected for write to the catalog interface.
-      Handle<TriggerResults> trHandle{getTriggerResults(e)};
-      auto const& trRef(trHandle.isValid() ?
-                          static_cast<HLTGlobalStatus>(*trHandle) :
-                          HLTGlobalStatus{});
-      ci_->eventSelected(
-        moduleDescription().moduleLabel(), ep.eventID(), trRef);
-      // ... and invoke the plugins:
-      cet::for_all(plugins_, [&e](auto& p) { p->doCollectMetadata(e); });
-      updateBranchParents(ep);
+      recordWrittenEvent(ep, mc);
     }
   }
 
+  void
+  OutputModule::doWriteEvents(vector<EventPrincipal*> const& eps,
+                              vector<ModuleContext> const& mcs)
+  {
+    FDEBUG(2) << "writeBatch called for " << eps.size() << " events\n";
+    assert(eps.size() == mcs.size());
+    vector<EventPrincipal*> selected;
+    vector<ModuleContext const*> selectedContexts;
+    for (size_t i = 0; i != eps.size(); ++i) {
+      auto const& mc = mcs[i];
+      if (wantEvent(mc.scheduleID(), std::as_const(*eps[i]).makeEvent(mc))) {
+        selected.push_back(eps[i]);
+        selectedContexts.push_back(&mc);
+      }
+    }
+    if (selected.empty()) {
+      return;
+    }
+    writeBatch(selected);
+    for (size_t i = 0; i != selected.size(); ++i) {
+      recordWrittenEvent(*selected[i], *selectedContexts[i]);
+    }
+  }
+
+  void
+  OutputModule::recordWrittenEvent(EventPrincipal& ep, ModuleContext const& mc)
+  {
+    auto const e = std::as_const(ep).makeEvent(mc);
+    // Declare that the event was selected for write to the catalog interface.
+    Handle<TriggerResults> trHandle{getTriggerResults(e)};
+    auto const& trRef(trHandle.isValid() ?
+                        static_cast<HLTGlobalStatus>(*trHandle) :
+                        HLTGlobalStatus{});
+    ci_->eventSelected(moduleDescription().moduleLabel(), ep.eventID(), trRef);
+    // ... and invoke the plugins:
+    cet::for_all(plugins_, [&e](auto& p) { p->doCollectMetadata(e); });
+    updateBranchParents(ep);
+  }
+
   void
   OutputModule::doSetSubRunAuxiliaryRangeSetID(RangeSet const& ranges)
   {
@@ -358,6 +392,19 @@ namespace art {
   {
     fillDependencyGraph();
     startEndFile();
+    if (auto endFile = detachEndFile()) {
+      // The metadata is collected now, from the services and plugins
+      // as they are at the end of the file.
+      FileCatalogMetadata::collection_type md;
+      FileCatalogMetadata::collection_type ssmd;
+      collectFileCatalogMetadata(md, ssmd);
+      detachedEndFile_ = [endFile = move(endFile),
+                          md = move(md),
+                          ssmd = move(ssmd)] { return endFile(md, ssmd); };
+      branchParents_.clear();
+      branchChildren_.clear();
+      return;
+    }
     writeFileFormatVersion();
     writeFileIdentifier();
     writeFileIndex();
@@ -433,6 +480,14 @@ namespace art {
   OutputModule::event(EventPrincipal const&)
   {}
 
+  void
+  OutputModule::writeBatch(vector<EventPrincipal*> const& events)
+  {
+    for (auto ep : events) {
+      write(*ep);
+    }
+  }
+
   void
   OutputModule::beginRun(RunPrincipal const&)
   {}
@@ -572,8 +627,18 @@ namespace art {
   void
   OutputModule::writeFileCatalogMetadata()
   {
-    // Obtain metadata from service for output.
     FileCatalogMetadata::collection_type md;
+    FileCatalogMetadata::collection_type ssmd;
+    collectFileCatalogMetadata(md, ssmd);
+    doWriteFileCatalogMetadata(md, ssmd);
+  }
+
+  void
+  OutputModule::collectFileCatalogMetadata(
+    FileCatalogMetadata::collection_type& md,
+    FileCatalogMetadata::collection_type& ssmd)
+  {
+    // Obtain metadata from service for output.
     ServiceHandle<FileCatalogMetadata const>
     {
       } -> getMetadata(md);
@@ -587,9 +652,7 @@ namespace art {
     // separate list for the output module. The user stream-specific
     // metadata should override stream-specific metadata generated by the
     // output module iself.
-    FileCatalogMetadata::collection_type ssmd;
     collectStreamSpecificMetadata(plugins_, pluginNames_, ssmd);
-    doWriteFileCatalogMetadata(md, ssmd);
   }
 
   void
@@ -606,6 +669,12 @@ namespace art {
   OutputModule::finishEndFile()
   {}
 
+  OutputModule::EndFileFunction
+  OutputModule::detachEndFile()
+  {
+    return {};
+  }
+
   OutputModule::PluginCollection_t
   OutputModule::makePlugins_(vector<ParameterSet> const& psets)
   {
@@ -33,11 +33,16 @@
 #include "fhiclcpp/types/OptionalDelegatedParameter.h"
 #include "fhiclcpp/types/Sequence.h"
 #include "fhiclcpp/types/TableFragment.h"
+#include "hep_concurrency/SerialTaskQueue.h"
 
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -56,6 +61,14 @@ namespace art {
     using PluginCollection_t =
       std::vector<std::unique_ptr<FileCatalogMetadataPlugin>>;
 
+    // Finishes a file that has been detached from the module (see
+    // detachEndFile), given the file-catalog metadata of the file and
+    // the stream-specific metadata from the plugins.  Returns the name
+    // under which the file has been closed.
+    using EndFileFunction = std::function<std::string(
+      FileCatalogMetadata::collection_type const& md,
+      FileCatalogMetadata::collection_type const& ssmd)>;
+
     struct Config {
       struct KeysToIgnore {
         std::set<std::string>
@@ -84,6 +97,15 @@ The ROOT output module supports the placeholders described at:
         ""};
       fhicl::Atom<std::string> dataTier{fhicl::Name("dataTier"), ""};
       fhicl::Atom<std::string> streamName{fhicl::Name("streamName"), ""};
+      fhicl::Atom<std::size_t> writeBatchSize{
+        fhicl::Name("writeBatchSize"),
+        fhicl::Comment(
+          "The maximum number of events that are handed to the module in\n"
+          "one call to 'writeBatch'.  Events are only batched if they are\n"
+          "waiting to be written when the module is ready for them, so no\n"
+          "event is held back to fill a batch.  Requests to close the\n"
+          "output file are honored once a whole batch has been written."),
+        1u};
       fhicl::OptionalDelegatedParameter fcmdPlugins{
         fhicl::Name("FCMDPlugins"),
         fhicl::Comment(
@@ -148,6 +170,9 @@ The ROOT output module supports the placeholders described at:
     void doWriteRun(RunPrincipal& rp);
     void doWriteSubRun(SubRunPrincipal& srp);
     void doWriteEvent(EventPrincipal& ep, ModuleContext const& mc);
+    void doWriteEvents(std::vector<EventPrincipal*> const& eps,
+                       std::vector<ModuleContext> const& mcs);
+    void recordWrittenEvent(EventPrincipal& ep, ModuleContext const& mc);
     void doSetRunAuxiliaryRangeSetID(RangeSet const&);
     void doSetSubRunAuxiliaryRangeSetID(RangeSet const&);
     bool doCloseFile();
@@ -181,6 +206,11 @@ The ROOT output module supports the placeholders described at:
     virtual void setSubRunAuxiliaryRangeSetID(RangeSet const&);
     virtual void event(EventPrincipal const&);
     virtual void write(EventPrincipal& e) = 0;
+    // Writes events that were selected for writing, in the order in
+    // which they are to be written.  The default implementation calls
+    // write() for each of them; modules override it to share the
+    // per-call costs of writing among the events of a batch.
+    virtual void writeBatch(std::vector<EventPrincipal*> const& events);
     virtual void openFile(FileBlock const&);
     virtual void respondToOpenInputFile(FileBlock const&);
     virtual void readResults(ResultsPrincipal const& resp);
@@ -203,11 +233,25 @@ The ROOT output module supports the placeholders described at:
     virtual void writeParentageRegistry();
     virtual void writeProductDescriptionRegistry();
     void writeFileCatalogMetadata();
+    void collectFileCatalogMetadata(FileCatalogMetadata::collection_type& md,
+                                    FileCatalogMetadata::collection_type& ssmd);
     virtual void doWriteFileCatalogMetadata(
       FileCatalogMetadata::collection_type const& md,
       FileCatalogMetadata::collection_type const& ssmd);
     virtual void writeProductDependencies();
     virtual void finishEndFile();
+    // An output module that can finish its files in the background
+    // overrides this to detach the file that startEndFile has just
+    // ended.  The returned function does, for that file, what the
+    // steps from writeFileFormatVersion to finishEndFile would have
+    // done.  It is run on a background task, so it must own all the
+    // state it uses (including a copy of branchChildren()), and the
+    // module may open its next file right away.  The closure of the
+    // file is announced to the catalog and to the PostCloseOutputFile
+    // watchers on the main thread, when the module next closes a file
+    // or ends the job.  The default returns an empty function, for
+    // which the steps are done in turn.
+    virtual EndFileFunction detachEndFile();
     PluginCollection_t makePlugins_(
       std::vector<fhicl::ParameterSet> const& psets);
 
@@ -234,12 +278,36 @@ The ROOT output module supports the placeholders described at:
     std::string configuredFileName_;
     std::string dataTier_;
     std::string streamName_;
+    std::size_t writeBatchSize_;
     ServiceHandle<CatalogInterface> ci_{};
     cet::BasicPluginFactory pluginFactory_{};
 
     // For diagnostics.
     std::vector<std::string> pluginNames_{};
     PluginCollection_t plugins_;
+
+    // Event writes are pushed onto writeQueue_, which is shared by the
+    // workers of this module on all schedules.  Different output
+    // modules therefore write concurrently, whereas the writes to any
+    // one module are serialized.  All other accesses to the output
+    // file are serialized against the queued writes by writeMutex_.
+    std::shared_ptr<hep::concurrency::SerialTaskQueue> writeQueue_{nullptr};
+    std::mutex writeMutex_{};
+
+    // Detached files are finished on endFileQueue_, in the order in
+    // which they were closed.  The names of the finished files, and
+    // the first error, are kept until the module is next closed or
+    // ended.
+    std::shared_ptr<hep::concurrency::SerialTaskQueue> endFileQueue_{nullptr};
+    std::function<std::string()> detachedEndFile_{};
+    std::deque<std::string> finishedFiles_{};
+    std::exception_ptr endFileError_{};
+    std::mutex endFileMutex_{};
+
+    // Event writes that have been queued but not yet started.  Each
+    // task on writeQueue_ writes up to writeBatchSize_ of them.
+    std::deque<OutputWorker::EventWrite> pendingWrites_{};
+    std::mutex pendingWritesMutex_{};
   };
 
 } // namespace art
@@ -9,6 +9,14 @@
 #include "art/Utilities/OutputFileInfo.h"
 #include "fhiclcpp/ParameterSetRegistry.h"
 
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+using namespace hep::concurrency;
+
 namespace art {
 
   OutputWorker::~OutputWorker() = default;
@@ -25,6 +33,10 @@ namespace art {
       // resources) once, not once for every schedule)
       module_->registerProducts(wp.producedProducts_);
       wp.resources_.registerSharedResources(module_->sharedResources());
+      // ...and the same holds for the queue of event writes.
+      module_->writeQueue_ = std::make_shared<SerialTaskQueue>(wp.taskGroup_);
+      module_->endFileQueue_ =
+        std::make_shared<SerialTaskQueue>(wp.taskGroup_);
     }
     ci_->outputModuleInitiated(
       label(),
@@ -46,6 +58,9 @@ namespace art {
   void
   OutputWorker::doEndJob()
   {
+    // The EventProcessor waits for the files that are being finished
+    // in the background before ending the job.
+    announceFinishedFiles_();
     module_->doEndJob();
   }
 
@@ -76,24 +91,28 @@ namespace art {
   void
   OutputWorker::doBegin(RunPrincipal& rp, ModuleContext const& mc)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doBeginRun(rp, mc);
   }
 
   void
   OutputWorker::doEnd(RunPrincipal& rp, ModuleContext const& mc)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doEndRun(rp, mc);
   }
 
   void
   OutputWorker::doBegin(SubRunPrincipal& srp, ModuleContext const& mc)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doBeginSubRun(srp, mc);
   }
 
   void
   OutputWorker::doEnd(SubRunPrincipal& srp, ModuleContext const& mc)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doEndSubRun(srp, mc);
   }
 
@@ -115,14 +134,58 @@ namespace art {
   void
   OutputWorker::closeFile()
   {
+    announceFinishedFiles_();
+    std::lock_guard sentry{module_->writeMutex_};
     actReg_.sPreCloseOutputFile.invoke(label());
     if (module_->doCloseFile()) {
+      if (auto endFile = std::exchange(module_->detachedEndFile_, {})) {
+        // The name of the file, and thus the notifications of its
+        // closure, are only known once it has been finished.
+        module_->endFileQueue_->push([this, endFile = std::move(endFile)] {
+          try {
+            auto fileName = endFile();
+            std::lock_guard sentry{module_->endFileMutex_};
+            module_->finishedFiles_.push_back(std::move(fileName));
+          }
+          catch (...) {
+            std::lock_guard sentry{module_->endFileMutex_};
+            if (!module_->endFileError_) {
+              module_->endFileError_ = std::current_exception();
+            }
+          }
+        });
+        return;
+      }
       ci_->outputFileClosed(label(), lastClosedFileName());
     }
     actReg_.sPostCloseOutputFile.invoke(
       OutputFileInfo{label(), lastClosedFileName()});
   }
 
+  // Called on the main thread, like closeFile, so that the catalog
+  // and the PostCloseOutputFile watchers need not be thread-safe.  The
+  // files that have been finished are announced in the order in which
+  // they were closed, and then the first error from finishing a file,
+  // if any, is rethrown.
+  void
+  OutputWorker::announceFinishedFiles_()
+  {
+    std::deque<std::string> fileNames;
+    std::exception_ptr ex;
+    {
+      std::lock_guard sentry{module_->endFileMutex_};
+      fileNames = std::exchange(module_->finishedFiles_, {});
+      ex = std::exchange(module_->endFileError_, nullptr);
+    }
+    for (auto const& fileName : fileNames) {
+      ci_->outputFileClosed(label(), fileName);
+      actReg_.sPostCloseOutputFile.invoke(OutputFileInfo{label(), fileName});
+    }
+    if (ex) {
+      std::rethrow_exception(ex);
+    }
+  }
+
   void
   OutputWorker::incrementInputFileNumber()
   {
@@ -132,12 +195,14 @@ namespace art {
   bool
   OutputWorker::requestsToCloseFile() const
   {
+    std::lock_guard sentry{module_->writeMutex_};
     return module_->requestsToCloseFile();
   }
 
   void
   OutputWorker::openFile(FileBlock const& fb)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     if (module_->doOpenFile(fb)) {
       ci_->outputFileOpened(label());
       actReg_.sPostOpenOutputFile.invoke(label());
@@ -147,33 +212,110 @@ namespace art {
   void
   OutputWorker::writeRun(RunPrincipal& rp)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doWriteRun(rp);
   }
 
   void
   OutputWorker::writeSubRun(SubRunPrincipal& srp)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doWriteSubRun(srp);
   }
 
   void
   OutputWorker::writeEvent(EventPrincipal& ep, PathContext const& pc)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     ModuleContext const mc{pc, description()};
     actReg_.sPreWriteEvent.invoke(mc);
     module_->doWriteEvent(ep, mc);
     actReg_.sPostWriteEvent.invoke(mc);
   }
 
+  SerialTaskQueue&
+  OutputWorker::writeQueue() const
+  {
+    return *module_->writeQueue_;
+  }
+
+  void
+  OutputWorker::queueEventWrite(EventPrincipal& ep,
+                                PathContext const& pc,
+                                std::function<void(std::exception_ptr)> done)
+  {
+    {
+      std::lock_guard sentry{module_->pendingWritesMutex_};
+      module_->pendingWrites_.push_back(EventWrite{&ep, pc, std::move(done)});
+    }
+    // One task per event is queued, so that every event is written
+    // even if no other event follows it.  A task that finds no
+    // pending write has had its event written with an earlier batch.
+    writeQueue().push([this] { writePendingEvents_(); });
+  }
+
+  void
+  OutputWorker::writePendingEvents_()
+  {
+    std::vector<EventWrite> writes;
+    {
+      std::lock_guard sentry{module_->pendingWritesMutex_};
+      auto& pending = module_->pendingWrites_;
+      auto const n = std::min(pending.size(), module_->writeBatchSize_);
+      auto const end = pending.begin() + n;
+      writes.assign(std::make_move_iterator(pending.begin()),
+                    std::make_move_iterator(end));
+      pending.erase(pending.begin(), end);
+    }
+    if (writes.empty()) {
+      return;
+    }
+    std::exception_ptr ex;
+    try {
+      if (writes.size() == 1u) {
+        writeEvent(*writes.front().ep, writes.front().pc);
+      } else {
+        writeEvents_(writes);
+      }
+    }
+    catch (...) {
+      ex = std::current_exception();
+    }
+    for (auto const& write : writes) {
+      write.done(ex);
+    }
+  }
+
+  void
+  OutputWorker::writeEvents_(std::vector<EventWrite> const& writes)
+  {
+    std::lock_guard sentry{module_->writeMutex_};
+    std::vector<EventPrincipal*> eps;
+    std::vector<ModuleContext> mcs;
+    eps.reserve(writes.size());
+    mcs.reserve(writes.size());
+    for (auto const& write : writes) {
+      eps.push_back(write.ep);
+      mcs.emplace_back(write.pc, description());
+      actReg_.sPreWriteEvent.invoke(mcs.back());
+    }
+    module_->doWriteEvents(eps, mcs);
+    for (auto const& mc : mcs) {
+      actReg_.sPostWriteEvent.invoke(mc);
+    }
+  }
+
   void
   OutputWorker::setRunAuxiliaryRangeSetID(RangeSet const& rs)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doSetRunAuxiliaryRangeSetID(rs);
   }
 
   void
   OutputWorker::setSubRunAuxiliaryRangeSetID(RangeSet const& rs)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     module_->doSetSubRunAuxiliaryRangeSetID(rs);
   }
 
@@ -186,6 +328,7 @@ namespace art {
   void
   OutputWorker::setFileStatus(OutputFileStatus const ofs)
   {
+    std::lock_guard sentry{module_->writeMutex_};
     return module_->setFileStatus(ofs);
   }
 
@@ -195,6 +338,13 @@ namespace art {
     module_->selectProducts(tables);
   }
 
+  bool
+  OutputWorker::keepsProduct(BranchDescription const& pd) const
+  {
+    auto const& kept = module_->keptProducts()[pd.branchType()];
+    return kept.find(pd.productID()) != kept.cend();
+  }
+
   Granularity
   OutputWorker::fileGranularity() const
   {
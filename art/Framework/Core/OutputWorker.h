@@ -15,10 +15,15 @@
 #include "art/Framework/Principal/fwd.h"
 #include "art/Framework/Services/FileServiceInterfaces/CatalogInterface.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art/Persistency/Provenance/PathContext.h"
 #include "art/Persistency/Provenance/fwd.h"
 #include "canvas/Persistency/Provenance/fwd.h"
+#include "hep_concurrency/SerialTaskQueue.h"
 
+#include <exception>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace art {
   struct OutputModuleDescription;
@@ -36,13 +41,36 @@ namespace art {
     void writeRun(RunPrincipal& rp);
     void writeSubRun(SubRunPrincipal& srp);
     void writeEvent(EventPrincipal& ep, PathContext const& pc);
+    // The queue onto which event writes to this module are pushed.
+    hep::concurrency::SerialTaskQueue& writeQueue() const;
+
+    // An event write that waits on the write queue.  The event must
+    // be kept alive until its done function has been called.
+    struct EventWrite {
+      EventPrincipal* ep;
+      PathContext pc;
+      std::function<void(std::exception_ptr)> done;
+    };
+    // Queues the write of an event.  The writes that are waiting when
+    // the queue gets to them are written together, up to the batch
+    // size of the module.  The done function of each event is called,
+    // with the exception if any, once its batch has been written.
+    void queueEventWrite(EventPrincipal& ep,
+                         PathContext const& pc,
+                         std::function<void(std::exception_ptr)> done);
     void setRunAuxiliaryRangeSetID(RangeSet const&);
     void setSubRunAuxiliaryRangeSetID(RangeSet const&);
     void setFileStatus(OutputFileStatus);
     Granularity fileGranularity() const;
     void selectProducts(ProductTables const&);
+    // Whether the product has been selected for writing.
+    bool keepsProduct(BranchDescription const&) const;
 
   private:
+    void announceFinishedFiles_();
+    void writePendingEvents_();
+    void writeEvents_(std::vector<EventWrite> const& writes);
+
     hep::concurrency::SerialTaskQueueChain* doSerialTaskQueueChain()
       const override;
     void doBeginJob(detail::SharedResources const&) override;
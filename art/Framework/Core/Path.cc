@@ -8,6 +8,7 @@
 #include "art/Framework/Services/Registry/ActivityRegistry.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "art/Framework/Services/System/TriggerNamesService.h"
+#include "art/Persistency/Provenance/ModuleDescription.h"
 #include "art/Utilities/GlobalTaskGroup.h"
 #include "art/Utilities/Globals.h"
 #include "art/Utilities/ScheduleID.h"
@@ -19,8 +20,11 @@
 #include "hep_concurrency/WaitingTask.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <exception>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,6 +33,46 @@ using namespace std;
 
 namespace art {
 
+  // The dependencies between the workers on a path, together with the
+  // state needed to run them for one event.  The per-event state is
+  // protected by the mutex, which is held only for bookkeeping.
+  class Path::WorkerGraph {
+  public:
+    explicit WorkerGraph(vector<vector<size_t>> const& prerequisites)
+      : numPrerequisites_(prerequisites.size())
+      , dependents_(prerequisites.size())
+      , remaining_(prerequisites.size())
+    {
+      for (size_t idx = 0; idx != prerequisites.size(); ++idx) {
+        numPrerequisites_[idx] = prerequisites[idx].size();
+        if (prerequisites[idx].empty()) {
+          roots_.push_back(idx);
+        }
+        for (auto const prerequisite : prerequisites[idx]) {
+          assert(prerequisite < idx);
+          dependents_[prerequisite].push_back(idx);
+        }
+      }
+    }
+
+    // Filled by ctor, const after that.
+    vector<size_t> numPrerequisites_;
+    vector<vector<size_t>> dependents_;
+    vector<size_t> roots_{};
+
+    // Per-event state.
+    std::mutex mutex_{};
+    vector<size_t> remaining_;
+    size_t inFlight_{};
+    // Position of the filter that rejected the event, or the number
+    // of workers if none did.  Workers after it are not run.
+    size_t rejectedAt_{};
+    // The first exception that terminated the path, and the position
+    // of the worker that threw it.
+    exception_ptr exception_{};
+    size_t failedAt_{};
+  };
+
   Path::Path(ActionTable const& actions,
              ActivityRegistry const& actReg,
              PathContext const& pc,
@@ -47,6 +91,16 @@ namespace art {
     TDEBUG_FUNC_SI(4, pc_.scheduleID()) << hex << this << dec;
   }
 
+  Path::~Path() = default;
+  Path::Path(Path&&) = default;
+
+  void
+  Path::runWorkersByDependencies(vector<vector<size_t>> const& prerequisites)
+  {
+    assert(prerequisites.size() == workers_.size());
+    workerGraph_ = make_unique<WorkerGraph>(prerequisites);
+  }
+
   ScheduleID
   Path::scheduleID() const
   {
@@ -108,10 +162,15 @@ namespace art {
   }
 
   void
-  Path::process(Transition const trans, Principal& principal)
+  Path::process(Transition const trans,
+                Principal& principal,
+                TransitionWorkers const which)
   {
+    // Path-level signals are not invoked when only the replicated
+    // workers of one schedule are being driven.
+    bool const invoke_signals = which != TransitionWorkers::Replicated;
     // Invoke pre-path signals only for the first schedule.
-    if (pc_.scheduleID() == ScheduleID::first()) {
+    if (invoke_signals && pc_.scheduleID() == ScheduleID::first()) {
       switch (trans) {
       case Transition::BeginRun:
         actReg_.sPrePathBeginRun.invoke(name());
@@ -138,6 +197,14 @@ namespace art {
       if (not wip.getWorker()->isUnique()) {
         continue;
       }
+      if (which != TransitionWorkers::All) {
+        bool const replicated =
+          wip.getWorker()->description().moduleThreadingType() ==
+          ModuleThreadingType::replicated;
+        if (replicated != (which == TransitionWorkers::Replicated)) {
+          continue;
+        }
+      }
       try {
         all_passed = wip.run(trans, principal);
         if (!all_passed)
@@ -162,8 +229,11 @@ namespace art {
     } else {
       state_ = hlt::Fail;
     }
-    // Invoke post-path signals only for the last schedule.
-    if (pc_.scheduleID().id() == Globals::instance()->nschedules() - 1) {
+    // Invoke post-path signals only for the last schedule, or for the
+    // only schedule that drives the shared workers.
+    if (invoke_signals &&
+        (which == TransitionWorkers::Shared ||
+         pc_.scheduleID().id() == Globals::instance()->nschedules() - 1)) {
       HLTPathStatus const status(state_, idx);
       switch (trans) {
       case Transition::BeginRun:
@@ -197,6 +267,11 @@ namespace art {
     actReg_.sPreProcessPath.invoke(pc_);
     ++timesRun_;
     state_ = hlt::Ready;
+    if (workerGraph_) {
+      process_event_graph(ep, pathsDoneTask);
+      TDEBUG_END_FUNC_SI(4, sid);
+      return;
+    }
     size_t idx = 0;
     auto max_idx = workers_.size();
     // Start the task spawn chain going with the first worker on the
@@ -219,7 +294,11 @@ namespace art {
       TDEBUG_END_TASK_SI(4, sid);
     }
     catch (...) {
-      taskGroup_.may_run(pathsDone, current_exception());
+      if (workerGraph_) {
+        process_event_pathTerminated(idx, current_exception(), pathsDone);
+      } else {
+        taskGroup_.may_run(pathsDone, current_exception());
+      }
       TDEBUG_END_TASK_SI(4, sid) << "path terminate because of EXCEPTION";
     }
   }
@@ -275,19 +354,12 @@ namespace art {
           assert(action != actions::FailModule);
           if (action != actions::FailPath) {
             // Possible actions: IgnoreCompletely, Rethrow, SkipEvent
-            ++path_->timesExcept_;
-            path_->state_ = hlt::Exception;
-            if (path_->trptr_) {
-              // Not the end path.
-              path_->trptr_->at(path_->pathPosition_) =
-                HLTPathStatus(path_->state_, idx_);
-            }
             auto art_ex =
               Exception{
                 errors::ScheduleExecutionFailure, "Path: ProcessingStopped.", e}
               << "Exception going through path " << path_->name() << '\n';
-            auto ex_ptr = make_exception_ptr(art_ex);
-            group_.may_run(pathsDone_, ex_ptr);
+            path_->process_event_pathTerminated(
+              idx_, make_exception_ptr(art_ex), pathsDone_);
             TDEBUG_END_TASK_SI(4, sid) << "terminate path because of EXCEPTION";
             return;
           }
@@ -300,14 +372,8 @@ namespace art {
         catch (...) {
           mf::LogError("PassingThrough")
             << "Exception passing through path " << path_->name();
-          ++path_->timesExcept_;
-          path_->state_ = hlt::Exception;
-          if (path_->trptr_) {
-            // Not the end path.
-            path_->trptr_->at(path_->pathPosition_) =
-              HLTPathStatus(path_->state_, idx_);
-          }
-          group_.may_run(pathsDone_, current_exception());
+          path_->process_event_pathTerminated(
+            idx_, current_exception(), pathsDone_);
           TDEBUG_END_TASK_SI(4, sid) << "terminate path because of EXCEPTION";
           return;
         }
@@ -353,6 +419,11 @@ namespace art {
     auto const sid = pc_.scheduleID();
     TDEBUG_BEGIN_FUNC_SI(4, sid) << "idx: " << idx << " max_idx: " << max_idx
                                  << " should_continue: " << should_continue;
+    if (workerGraph_) {
+      process_event_graphWorkerFinished(idx, ep, should_continue, pathsDone);
+      TDEBUG_END_FUNC_SI(4, sid) << "idx: " << idx << " max_idx: " << max_idx;
+      return;
+    }
     auto new_idx = idx + 1;
     // Move on to the next worker.
     if (should_continue && (new_idx < max_idx)) {
@@ -405,4 +476,119 @@ namespace art {
                            << (ex_ptr ? " EXCEPTION" : "");
   }
 
+  void
+  Path::process_event_pathTerminated(size_t const idx,
+                                     exception_ptr const ex,
+                                     WaitingTaskPtr pathsDone)
+  {
+    if (workerGraph_) {
+      // Other workers on this path may still be running; the path is
+      // terminated once they have finished.
+      auto& graph = *workerGraph_;
+      bool last_in_flight{false};
+      {
+        std::lock_guard sentry{graph.mutex_};
+        if (!graph.exception_) {
+          graph.exception_ = ex;
+          graph.failedAt_ = idx;
+        }
+        last_in_flight = --graph.inFlight_ == 0;
+      }
+      if (last_in_flight) {
+        process_event_graphFinished(pathsDone);
+      }
+      return;
+    }
+    ++timesExcept_;
+    state_ = hlt::Exception;
+    if (trptr_) {
+      // Not the end path.
+      trptr_->at(pathPosition_) = HLTPathStatus(state_, idx);
+    }
+    taskGroup_.may_run(pathsDone, ex);
+  }
+
+  // Start every worker that does not depend on another worker on
+  // this path.  The remaining workers are started as their
+  // prerequisites finish.
+  void
+  Path::process_event_graph(EventPrincipal& ep, WaitingTaskPtr pathsDone)
+  {
+    auto& graph = *workerGraph_;
+    auto const max_idx = workers_.size();
+    {
+      std::lock_guard sentry{graph.mutex_};
+      graph.remaining_ = graph.numPrerequisites_;
+      graph.inFlight_ = graph.roots_.size();
+      graph.rejectedAt_ = max_idx;
+      graph.exception_ = nullptr;
+      graph.failedAt_ = max_idx;
+    }
+    if (graph.roots_.empty()) {
+      process_event_pathFinished(max_idx, true, pathsDone);
+      return;
+    }
+    for (auto const idx : graph.roots_) {
+      process_event_idx_asynch(idx, max_idx, ep, pathsDone);
+    }
+  }
+
+  void
+  Path::process_event_graphWorkerFinished(size_t const idx,
+                                          EventPrincipal& ep,
+                                          bool const should_continue,
+                                          WaitingTaskPtr pathsDone)
+  {
+    auto& graph = *workerGraph_;
+    auto const max_idx = workers_.size();
+    vector<size_t> ready;
+    bool last_in_flight{false};
+    {
+      std::lock_guard sentry{graph.mutex_};
+      if (!should_continue) {
+        // Every worker after a filter depends on it, so none of them
+        // has been started yet.
+        graph.rejectedAt_ = std::min(graph.rejectedAt_, idx);
+      }
+      for (auto const dependent : graph.dependents_[idx]) {
+        if (--graph.remaining_[dependent] == 0 &&
+            dependent < graph.rejectedAt_ && !graph.exception_) {
+          ready.push_back(dependent);
+        }
+      }
+      graph.inFlight_ += ready.size();
+      last_in_flight = --graph.inFlight_ == 0;
+    }
+    for (auto const dependent : ready) {
+      process_event_idx_asynch(dependent, max_idx, ep, pathsDone);
+    }
+    if (last_in_flight) {
+      process_event_graphFinished(pathsDone);
+    }
+  }
+
+  // Called once no worker on this path is running for the current
+  // event, so the per-event state can be read without the lock.
+  void
+  Path::process_event_graphFinished(WaitingTaskPtr pathsDone)
+  {
+    auto const& graph = *workerGraph_;
+    if (graph.exception_) {
+      ++timesExcept_;
+      state_ = hlt::Exception;
+      if (trptr_) {
+        // Not the end path.
+        trptr_->at(pathPosition_) = HLTPathStatus(state_, graph.failedAt_);
+      }
+      taskGroup_.may_run(pathsDone, graph.exception_);
+      return;
+    }
+    auto const max_idx = workers_.size();
+    if (graph.rejectedAt_ != max_idx) {
+      process_event_pathFinished(graph.rejectedAt_ + 1, false, pathsDone);
+      return;
+    }
+    process_event_pathFinished(max_idx, true, pathsDone);
+  }
+
 } // namespace art
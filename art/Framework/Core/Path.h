@@ -10,6 +10,7 @@
 // that per-path execution statistics can be kept for each worker.
 // ====================================================================
 
+#include "art/Framework/Core/TransitionWorkers.h"
 #include "art/Framework/Core/WorkerInPath.h"
 #include "art/Framework/Principal/fwd.h"
 #include "art/Persistency/Provenance/PathContext.h"
@@ -22,6 +23,8 @@
 #include "hep_concurrency/WaitingTask.h"
 
 #include <cstddef>
+#include <exception>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,6 +39,8 @@ namespace art {
          std::vector<WorkerInPath>&&,
          HLTGlobalStatus*,
          GlobalTaskGroup&) noexcept;
+    ~Path();
+    Path(Path&&);
 
     ScheduleID scheduleID() const;
     PathSpec const& pathSpec() const;
@@ -49,12 +54,22 @@ namespace art {
     std::size_t timesExcept() const;
     // Note: threading: Clears the counters of workersInPath.
     void clearCounters();
-    void process(Transition, Principal&);
+    void process(Transition,
+                 Principal&,
+                 TransitionWorkers = TransitionWorkers::All);
     void process(hep::concurrency::WaitingTaskPtr pathsDoneTask,
                  EventPrincipal&);
 
+    // Run each worker as soon as the workers it depends on have
+    // finished, instead of strictly in path order.  The prerequisites
+    // of a worker are given as positions on the path, all of which
+    // must precede the position of the worker itself.
+    void runWorkersByDependencies(
+      std::vector<std::vector<std::size_t>> const& prerequisites);
+
   private:
     class WorkerDoneTask;
+    class WorkerGraph;
 
     void runWorkerTask(size_t idx,
                        size_t max_idx,
@@ -78,6 +93,19 @@ namespace art {
     void process_event_pathFinished(size_t const idx,
                                     bool should_continue,
                                     hep::concurrency::WaitingTaskPtr pathsDone);
+    void process_event_pathTerminated(
+      size_t const idx,
+      std::exception_ptr ex,
+      hep::concurrency::WaitingTaskPtr pathsDone);
+    void process_event_graph(EventPrincipal&,
+                             hep::concurrency::WaitingTaskPtr pathsDone);
+    void process_event_graphWorkerFinished(
+      size_t const idx,
+      EventPrincipal& ep,
+      bool should_continue,
+      hep::concurrency::WaitingTaskPtr pathsDone);
+    void process_event_graphFinished(
+      hep::concurrency::WaitingTaskPtr pathsDone);
 
     ActionTable const& actionTable_;
     ActivityRegistry const& actReg_;
@@ -91,6 +119,9 @@ namespace art {
 
     GlobalTaskGroup& taskGroup_;
 
+    // Only present if the workers are run by dependencies.
+    std::unique_ptr<WorkerGraph> workerGraph_{nullptr};
+
     // These are adjusted in a serialized context.
     hlt::HLTState state_{hlt::Ready};
     std::size_t timesRun_{};
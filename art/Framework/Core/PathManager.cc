@@ -2,6 +2,7 @@
 // vim: set sw=2 expandtab :
 
 #include "art/Framework/Core/ModuleBase.h"
+#include "art/Framework/Core/OutputWorker.h"
 #include "art/Framework/Core/PathsInfo.h"
 #include "art/Framework/Core/TriggerResultInserter.h"
 #include "art/Framework/Core/WorkerInPath.h"
@@ -9,6 +10,9 @@
 #include "art/Framework/Core/detail/consumed_products.h"
 #include "art/Framework/Core/detail/graph_algorithms.h"
 #include "art/Framework/Core/fwd.h"
+#include "art/Framework/Principal/ConsumesInfo.h"
+#include "art/Framework/Principal/ProductEviction.h"
+#include "art/Framework/Principal/ProductInfo.h"
 #include "art/Framework/Principal/Worker.h"
 #include "art/Framework/Principal/WorkerParams.h"
 #include "art/Framework/Services/Registry/ActivityRegistry.h"
@@ -23,6 +27,7 @@
 #include "art/Utilities/TaskDebugMacros.h"
 #include "art/Utilities/detail/remove_whitespace.h"
 #include "art/Version/GetReleaseVersion.h"
+#include "canvas/Persistency/Provenance/BranchType.h"
 #include "canvas/Utilities/Exception.h"
 #include "cetlib/HorizontalRule.h"
 #include "cetlib/LibraryManager.h"
@@ -55,15 +60,56 @@ using fhicl::ParameterSet;
 namespace art {
 
   namespace {
+    // The products of the on-demand producers are visible to the
+    // modules on every path, so their labels are included.
     std::vector<std::string>
-    sorted_module_labels(std::vector<WorkerInPath::ConfigInfo> const& wcis)
+    sorted_module_labels(std::vector<WorkerInPath::ConfigInfo> const& wcis,
+                         std::vector<std::string> const& on_demand_labels = {})
     {
       auto to_label = [](auto const& wci) {
         return wci.moduleConfigInfo->modDescription.moduleLabel();
       };
       using namespace ::ranges;
-      return wcis | views::transform(to_label) | to<std::vector>() |
-             ::ranges::actions::sort;
+      auto labels = wcis | views::transform(to_label) | to<std::vector>();
+      labels.insert(
+        end(labels), cbegin(on_demand_labels), cend(on_demand_labels));
+      return std::move(labels) | ::ranges::actions::sort;
+    }
+
+    // Verify that the on-demand producers, given by their
+    // prerequisites, do not depend on one another in a cycle.
+    void
+    verify_no_on_demand_cycles(std::vector<std::string> const& labels,
+                               std::vector<std::vector<size_t>> const& prereqs)
+    {
+      enum class Mark { none, visiting, done };
+      std::vector<Mark> marks(size(labels), Mark::none);
+      std::vector<size_t> chain;
+      auto visit = [&](auto const& self, size_t const idx) -> void {
+        if (marks[idx] == Mark::done) {
+          return;
+        }
+        chain.push_back(idx);
+        if (marks[idx] == Mark::visiting) {
+          Exception e{errors::Configuration};
+          e << "The following on-demand producers depend on one another in "
+               "a cycle:\n";
+          auto const first = std::find(cbegin(chain), cend(chain), idx);
+          for (auto it = first; it != cend(chain); ++it) {
+            e << "  " << labels[*it] << '\n';
+          }
+          throw e;
+        }
+        marks[idx] = Mark::visiting;
+        for (auto const prereq : prereqs[idx]) {
+          self(self, prereq);
+        }
+        marks[idx] = Mark::done;
+        chain.pop_back();
+      };
+      for (size_t idx = 0; idx != size(labels); ++idx) {
+        visit(visit, idx);
+      }
     }
   } // anonymous namespace
 
@@ -83,6 +129,7 @@ namespace art {
     , productsToProduce_{productsToProduce}
     , processName_{procPS.get<string>("process_name", {})}
     , allModules_{moduleInformation_(enabled_modules)}
+    , onDemandLabels_{enabled_modules.on_demand_modules()}
     , triggerResultsWorkers_{Globals::instance()->nschedules()}
   {
     // Trigger paths
@@ -169,7 +216,8 @@ namespace art {
   PathManager::createModulesAndWorkers(
     GlobalTaskGroup& task_group,
     detail::SharedResources& resources,
-    std::vector<std::string> const& producing_services)
+    std::vector<std::string> const& producing_services,
+    WorkerOptions const& options)
   {
     // For each configured schedule, create the trigger paths and the
     // workers on each path.
@@ -180,6 +228,13 @@ namespace art {
     // workers claim (co-)ownership of the modules, the 'modules'
     // object can be destroyed.
     modules_ = makeModules_(nschedules);
+    // No more consumes statements can be made; the consumes
+    // information is now read without locking.
+    ConsumesInfo::instance()->sealConsumes();
+
+    // The on-demand workers are made first so that the workers on the
+    // paths can be told which of them to run beforehand.
+    makeOnDemandWorkers_(task_group, resources);
 
     // FIXME: THE PATHS INFO OBJECTS SHOULD BECOME OWNERS OF THE WORKERS
     //        I IMAGINE AN API LIKE:
@@ -200,7 +255,9 @@ namespace art {
            protoTrigPathLabels_) {
 
         PathContext const pc{
-          sc, path_spec, sorted_module_labels(worker_config_infos)};
+          sc,
+          path_spec,
+          sorted_module_labels(worker_config_infos, onDemandLabels_)};
         auto wips = fillWorkers_(
           pc, worker_config_infos, pinfo.workers(), task_group, resources);
         pinfo.add_path(
@@ -262,6 +319,18 @@ namespace art {
       throw Exception{errors::Configuration} << err << '\n';
     }
 
+    if (options.runModulesByDependencies) {
+      runTriggerPathsByDependencies_(modInfos);
+    }
+
+    if (options.prefetchConsumedProducts) {
+      prefetchConsumedProducts_(task_group);
+    }
+
+    if (options.evictConsumedProducts) {
+      evictConsumedProducts_();
+    }
+
     // No longer need worker/module config objects.
     protoTrigPathLabels_.clear();
     protoEndPathLabels_.clear();
@@ -511,12 +580,148 @@ namespace art {
 
       assert(worker);
       workers.emplace(module_label, worker);
-      wips.emplace_back(
+      auto& wip = wips.emplace_back(
         cet::make_exempt_ptr(worker.get()), filterAction, pc, task_group);
+      if (auto indices = onDemandPrerequisites_(module_label);
+          !indices.empty()) {
+        auto& on_demand = triggerPathsInfo_[sid].onDemandWorkers();
+        wip.runAfter(cet::make_exempt_ptr(&on_demand), std::move(indices));
+      }
     }
     return wips;
   }
 
+  void
+  PathManager::makeOnDemandWorkers_(GlobalTaskGroup& task_group,
+                                    detail::SharedResources& resources)
+  {
+    if (onDemandLabels_.empty()) {
+      return;
+    }
+
+    // All workers must exist, and hence all products be registered,
+    // before the dependencies among them can be determined.
+    auto const nschedules =
+      static_cast<ScheduleID::size_type>(Globals::instance()->nschedules());
+    PerScheduleContainer<vector<std::shared_ptr<Worker>>> workers(nschedules);
+    for (ScheduleID::size_type i = 0; i != nschedules; ++i) {
+      ScheduleID const sid{i};
+      WorkerParams const wp{outputCallbacks_,
+                            productsToProduce_,
+                            actReg_,
+                            exceptActions_,
+                            sid,
+                            task_group.native_group(),
+                            resources};
+      for (auto const& module_label : onDemandLabels_) {
+        auto worker =
+          makeWorker_(allModules_.at(module_label).modDescription, wp);
+        triggerPathsInfo_[sid].workers().emplace(module_label, worker);
+        workers[sid].push_back(std::move(worker));
+      }
+    }
+
+    // An on-demand producer may only consume the products of the
+    // input source and of other on-demand producers: it is not run
+    // on a path, so it cannot wait for a module on one.
+    vector<vector<size_t>> prerequisites;
+    prerequisites.reserve(size(onDemandLabels_));
+    for (auto const& module_label : onDemandLabels_) {
+      auto const& consumables =
+        ConsumesInfo::instance()->consumables(module_label);
+      for (auto const& per_branch_type : consumables) {
+        for (auto const& info : per_branch_type) {
+          if (info.consumableType == ProductInfo::ConsumableType::Many) {
+            continue;
+          }
+          auto const& process_name = info.process.name();
+          if (!process_name.empty() && process_name != processName_) {
+            continue;
+          }
+          if (cet::binary_search_all(onDemandLabels_, info.label)) {
+            continue;
+          }
+          auto it = allModules_.find(info.label);
+          if (it == cend(allModules_) ||
+              !is_modifier(it->second.moduleType)) {
+            continue;
+          }
+          throw Exception{errors::Configuration}
+            << "The on-demand producer " << module_label
+            << " consumes products from module " << info.label << ",\n"
+            << "which is not run on demand.  An on-demand producer may only "
+               "consume\n"
+            << "products from the input source or from other on-demand "
+               "producers.\n";
+        }
+      }
+      prerequisites.push_back(onDemandPrerequisites_(module_label));
+    }
+    verify_no_on_demand_cycles(onDemandLabels_, prerequisites);
+
+    for (ScheduleID::size_type i = 0; i != nschedules; ++i) {
+      ScheduleID const sid{i};
+      PathContext const pc{ScheduleContext{sid},
+                           PathContext::on_demand_path_spec(),
+                           onDemandLabels_};
+      auto& on_demand = triggerPathsInfo_[sid].onDemandWorkers();
+      for (size_t idx = 0; idx != size(onDemandLabels_); ++idx) {
+        on_demand.add(cet::make_exempt_ptr(workers[sid][idx].get()),
+                      pc,
+                      prerequisites[idx],
+                      task_group);
+      }
+    }
+  }
+
+  // The positions, in the list of on-demand labels, of the on-demand
+  // producers whose event products the module consumes.
+  vector<size_t>
+  PathManager::onDemandPrerequisites_(string const& module_label) const
+  {
+    vector<size_t> result;
+    if (onDemandLabels_.empty()) {
+      return result;
+    }
+    auto index_of = [this](string const& label) {
+      return static_cast<size_t>(
+        std::lower_bound(
+          cbegin(onDemandLabels_), cend(onDemandLabels_), label) -
+        cbegin(onDemandLabels_));
+    };
+    auto add = [this, &result, &module_label, &index_of](string const& label) {
+      if (label == module_label ||
+          !cet::binary_search_all(onDemandLabels_, label)) {
+        return;
+      }
+      result.push_back(index_of(label));
+    };
+
+    auto const& consumables =
+      ConsumesInfo::instance()->consumables(module_label)[InEvent];
+    for (auto const& info : consumables) {
+      if (info.consumableType == ProductInfo::ConsumableType::Many) {
+        // A getMany call may retrieve the products of every on-demand
+        // producer that makes products of the requested type.
+        for (auto const& pd : productsToProduce_) {
+          if (pd.branchType() == InEvent &&
+              pd.friendlyClassName() == info.friendlyClassName) {
+            add(pd.moduleLabel());
+          }
+        }
+        continue;
+      }
+      auto const& process_name = info.process.name();
+      if (!process_name.empty() && process_name != processName_) {
+        continue;
+      }
+      add(info.label);
+    }
+    cet::sort_all(result);
+    result.erase(std::unique(begin(result), end(result)), end(result));
+    return result;
+  }
+
   std::shared_ptr<Worker>
   PathManager::makeWorker_(ModuleDescription const& md, WorkerParams const& wp)
   {
@@ -676,6 +881,113 @@ namespace art {
                                              viewable_products,
                                              worker_config_begin,
                                              it);
+      if (onDemandLabels_.empty()) {
+        continue;
+      }
+      // Like those of the input source, the products of on-demand
+      // producers are available to modules on every path.
+      std::set<ProductInfo> consumed;
+      for (auto info : graph_info.consumed_products) {
+        if (cet::binary_search_all(onDemandLabels_, info.label)) {
+          info.label = "input_source";
+        }
+        consumed.insert(std::move(info));
+      }
+      graph_info.consumed_products = std::move(consumed);
+    }
+  }
+
+  // A worker on a trigger path must wait for (a) the workers before
+  // it on the path whose products it consumes, and (b) every filter
+  // before it on the path that may reject the event, so that a
+  // rejection still prevents everything after the filter from
+  // running.
+  void
+  PathManager::runTriggerPathsByDependencies_(
+    ModuleGraphInfoMap const& modInfos)
+  {
+    size_t path_index{};
+    for (auto const& worker_configs :
+         protoTrigPathLabels_ | ::ranges::views::values) {
+      vector<vector<size_t>> prerequisites(size(worker_configs));
+      for (size_t i = 0; i != size(worker_configs); ++i) {
+        auto const& label =
+          worker_configs[i].moduleConfigInfo->modDescription.moduleLabel();
+        auto const& consumed = modInfos.info(label).consumed_products;
+        for (size_t j = 0; j != i; ++j) {
+          auto const& upstream = worker_configs[j];
+          auto const& upstream_label =
+            upstream.moduleConfigInfo->modDescription.moduleLabel();
+          bool const may_reject =
+            upstream.moduleConfigInfo->moduleType == ModuleType::filter &&
+            upstream.filterAction != detail::FilterAction::Ignore;
+          bool const consumes_from =
+            std::any_of(cbegin(consumed),
+                        cend(consumed),
+                        [&upstream_label](auto const& info) {
+                          return info.label == upstream_label;
+                        });
+          if (may_reject || consumes_from) {
+            prerequisites[i].push_back(j);
+          }
+        }
+      }
+      for (auto& pinfo : triggerPathsInfo_) {
+        pinfo.paths().at(path_index).runWorkersByDependencies(prerequisites);
+      }
+      ++path_index;
+    }
+  }
+
+  void
+  PathManager::prefetchConsumedProducts_(GlobalTaskGroup& task_group)
+  {
+    auto prefetch = [&task_group](PathsInfo& pinfo) {
+      for (auto const& [module_label, worker] : pinfo.workers()) {
+        auto const consumed =
+          ConsumesInfo::instance()->sealedConsumables(module_label);
+        assert(consumed != nullptr);
+        worker->prefetchConsumedProducts(*consumed, task_group);
+      }
+    };
+    // The on-demand workers are among the workers of the trigger paths.
+    for (auto& pinfo : triggerPathsInfo_) {
+      prefetch(pinfo);
+    }
+    for (auto& einfo : endPathInfo_) {
+      prefetch(einfo);
+    }
+  }
+
+  void
+  PathManager::evictConsumedProducts_()
+  {
+    // A module is one consumer, whichever schedule its worker is on.
+    auto eviction = ProductEviction::instance();
+    map<string, size_t> consumers;
+    auto evict = [eviction, &consumers](PathsInfo& pinfo) {
+      for (auto const& [module_label, worker] : pinfo.workers()) {
+        auto it = consumers.find(module_label);
+        if (it == consumers.end()) {
+          auto const& consumables =
+            ConsumesInfo::instance()->consumables(module_label);
+          auto const consumer = eviction->addConsumer(consumables[InEvent]);
+          it = consumers.emplace(module_label, consumer).first;
+          if (auto ow = std::dynamic_pointer_cast<OutputWorker>(worker)) {
+            eviction->addOutputSelection(
+              [ow](BranchDescription const& pd) {
+                return ow->keepsProduct(pd);
+              });
+          }
+        }
+        worker->evictConsumedProducts(it->second);
+      }
+    };
+    for (auto& pinfo : triggerPathsInfo_) {
+      evict(pinfo);
+    }
+    for (auto& einfo : endPathInfo_) {
+      evict(einfo);
     }
   }
 
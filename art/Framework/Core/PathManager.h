@@ -29,6 +29,7 @@
 #include "cetlib/LibraryManager.h"
 #include "fhiclcpp/ParameterSet.h"
 
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <set>
@@ -44,11 +45,19 @@ namespace art {
   class UpdateOutputCallbacks;
 
   namespace detail {
+    class ModuleGraphInfoMap;
     class SharedResources;
   }
 
   class PathManager {
   public:
+    // The scheduler settings that determine how the workers are run.
+    struct WorkerOptions {
+      bool runModulesByDependencies{false};
+      bool prefetchConsumedProducts{false};
+      bool evictConsumedProducts{false};
+    };
+
     PathManager(fhicl::ParameterSet const& procPS,
                 UpdateOutputCallbacks& preg,
                 ProductDescriptions& productsToProduce,
@@ -66,7 +75,8 @@ namespace art {
     void createModulesAndWorkers(
       GlobalTaskGroup& task_group,
       detail::SharedResources& resources,
-      std::vector<std::string> const& producing_services);
+      std::vector<std::string> const& producing_services,
+      WorkerOptions const& options);
     std::unique_ptr<Worker> releaseTriggerResultsInserter(ScheduleID);
     PathsInfo& triggerPathsInfo(ScheduleID);
     PerScheduleContainer<PathsInfo> const& triggerPathsInfo();
@@ -100,6 +110,10 @@ namespace art {
       detail::SharedResources& resources);
     std::shared_ptr<Worker> makeWorker_(ModuleDescription const& md,
                                         WorkerParams const& wp);
+    void makeOnDemandWorkers_(GlobalTaskGroup& task_group,
+                              detail::SharedResources& resources);
+    std::vector<std::size_t> onDemandPrerequisites_(
+      std::string const& module_label) const;
     ModuleType loadModuleType_(std::string const& lib_spec) const;
     ModuleThreadingType loadModuleThreadingType_(
       std::string const& lib_spec) const;
@@ -115,6 +129,10 @@ namespace art {
       detail::collection_map_t& info_collection) const;
     void fillSelectEventsDeps_(detail::configs_t const& worker_configs,
                                detail::collection_map_t& info_collection) const;
+    void runTriggerPathsByDependencies_(
+      detail::ModuleGraphInfoMap const& modInfos);
+    void prefetchConsumedProducts_(GlobalTaskGroup& task_group);
+    void evictConsumedProducts_();
 
     std::vector<std::string> triggerPathNames_() const;
     std::vector<std::string> prependedTriggerPathNames_() const;
@@ -136,6 +154,8 @@ namespace art {
     //  fixed.
     std::string processName_{};
     std::map<std::string, detail::ModuleConfigInfo> allModules_{};
+    // Sorted labels of the producers that are run on demand.
+    std::vector<std::string> onDemandLabels_{};
     art::detail::paths_to_modules_t protoTrigPathLabels_{};
     art::detail::configs_t protoEndPathLabels_{};
     ModulesByThreadingType modules_{};
@@ -73,6 +73,18 @@ namespace art {
     return result;
   }
 
+  OnDemandWorkers&
+  PathsInfo::onDemandWorkers()
+  {
+    return onDemandWorkers_;
+  }
+
+  OnDemandWorkers const&
+  PathsInfo::onDemandWorkers() const
+  {
+    return onDemandWorkers_;
+  }
+
   void
   PathsInfo::reset()
   {
@@ -2,6 +2,7 @@
 #define art_Framework_Core_PathsInfo_h
 // vim: set sw=2 expandtab :
 
+#include "art/Framework/Core/OnDemandWorkers.h"
 #include "art/Framework/Core/Path.h"
 #include "art/Framework/Principal/Worker.h"
 #include "canvas/Persistency/Common/HLTGlobalStatus.h"
@@ -26,6 +27,8 @@ namespace art {
     std::vector<Path>& paths();
     std::vector<Path> const& paths() const;
     std::vector<std::string> pathNames() const;
+    OnDemandWorkers& onDemandWorkers();
+    OnDemandWorkers const& onDemandWorkers() const;
     HLTGlobalStatus& pathResults();
     void reset();
     void reset_for_event();
@@ -39,6 +42,8 @@ namespace art {
     // Maps module_label to Worker.
     std::map<std::string, std::shared_ptr<Worker>> workers_{};
     std::vector<Path> paths_{};
+    // The on-demand workers are also held in workers_.
+    OnDemandWorkers onDemandWorkers_{};
     HLTGlobalStatus pathResults_{};
     std::atomic<std::size_t> totalEvents_{};
     std::atomic<std::size_t> passedEvents_{};
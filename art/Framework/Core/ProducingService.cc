@@ -20,10 +20,10 @@ namespace art {
   void
   ProducingService::setModuleDescription(ModuleDescription const& md)
   {
-    // We choose the one-argument constructor since the path
+    // We choose the constructor without a path context since the path
     // information is irrelevant when the doPostRead* functions are
-    // invoked.
-    mc_ = ModuleContext{md};
+    // invoked.  The products have already been registered.
+    mc_ = ModuleContext{md, slotLayout()};
   }
 
   void
@@ -1,6 +1,7 @@
 #include "art/Framework/Core/ProductRegistryHelper.h"
 // vim: set sw=2:
 
+#include "art/Persistency/Provenance/ModuleDescription.h"
 #include "canvas/Persistency/Provenance/BranchDescription.h"
 #include "canvas/Persistency/Provenance/BranchType.h"
 #include "canvas/Persistency/Provenance/ProductList.h"
@@ -9,6 +10,7 @@
 #include "range/v3/view.hpp"
 
 #include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -48,6 +50,19 @@ namespace art {
   ProductRegistryHelper::fillDescriptions(ModuleDescription const& md)
   {
     collector_.fillDescriptions(md);
+    // Reconstituted products bear the label of the module that
+    // originally made them, and cannot be put by this one.
+    vector<BranchDescription> products;
+    for_each_branch_type([this, &md, &products](BranchType const bt) {
+      for (auto const& pd :
+           collector_.expectedProducts(bt) | ::ranges::views::values) {
+        if (pd.moduleLabel() == md.moduleLabel() &&
+            pd.processName() == md.processName()) {
+          products.push_back(pd);
+        }
+      }
+    });
+    slotLayout_ = make_shared<ProductSlotLayout const>(move(products));
   }
 
 } // namespace art
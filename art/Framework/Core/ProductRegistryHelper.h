@@ -18,6 +18,7 @@
 // ===================================================================
 
 #include "art/Framework/Core/ProducesCollector.h"
+#include "art/Persistency/Provenance/ProductSlotLayout.h"
 #include "canvas/Persistency/Provenance/BranchDescription.h"
 #include "canvas/Persistency/Provenance/BranchType.h"
 #include "canvas/Persistency/Provenance/Persistable.h"
@@ -59,6 +60,14 @@ namespace art {
 
     void fillDescriptions(ModuleDescription const& md);
 
+    // The products that the module may put, which are known once its
+    // descriptions have been filled.
+    std::shared_ptr<ProductSlotLayout const> const&
+    slotLayout() const noexcept
+    {
+      return slotLayout_;
+    }
+
     // Record the reconstitution of an object of type P, in either the
     // Run, SubRun, or Event, recording that this object was
     // originally created by a module with label modLabel, and with an
@@ -86,6 +95,7 @@ namespace art {
     std::unique_ptr<ProductList const> productList_{nullptr};
     product_creation_mode mode_;
     ProducesCollector collector_;
+    std::shared_ptr<ProductSlotLayout const> slotLayout_{nullptr};
   };
 
   template <BranchType B>
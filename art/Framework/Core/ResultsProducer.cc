@@ -103,7 +103,7 @@ namespace art {
   void
   ResultsProducer::doWriteResults(ResultsPrincipal& resp)
   {
-    ModuleContext const mc{moduleDescription()};
+    ModuleContext const mc{moduleDescription(), slotLayout()};
     auto res = resp.makeResults(mc);
     writeResults(res);
     res.commitProducts();
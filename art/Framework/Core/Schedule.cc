@@ -72,10 +72,12 @@ namespace art {
   }
 
   void
-  Schedule::process(Transition const trans, Principal& principal)
+  Schedule::process(Transition const trans,
+                    Principal& principal,
+                    TransitionWorkers const which)
   {
-    tpsExec_.process(trans, principal);
-    epExec_.process(trans, principal);
+    tpsExec_.process(trans, principal, which);
+    epExec_.process(trans, principal, which);
   }
 
   void
@@ -14,6 +14,7 @@
 // ======================================================================
 
 #include "art/Framework/Core/EndPathExecutor.h"
+#include "art/Framework/Core/TransitionWorkers.h"
 #include "art/Framework/Core/TriggerPathsExecutor.h"
 #include "art/Framework/Core/fwd.h"
 #include "art/Framework/Principal/EventPrincipal.h"
@@ -45,7 +46,9 @@ namespace art {
     Schedule& operator=(Schedule&&) = delete;
 
     // API presented to EventProcessor
-    void process(Transition, Principal&);
+    void process(Transition,
+                 Principal&,
+                 TransitionWorkers = TransitionWorkers::All);
     void process_event_modifiers(hep::concurrency::WaitingTaskPtr endPathTask);
     void process_event_observers(
       hep::concurrency::WaitingTaskPtr finalizeEventTask);
@@ -99,11 +102,34 @@ namespace art {
       epExec_.closeSomeOutputFiles();
     }
 
+    // The event principal must be kept alive until writeDoneTask runs.
     void
-    writeEvent()
+    writeEvent(hep::concurrency::WaitingTaskPtr const writeDoneTask)
     {
       assert(eventPrincipal_);
-      epExec_.writeEvent(*eventPrincipal_);
+      epExec_.writeEvent(writeDoneTask, *eventPrincipal_);
+    }
+
+    // For an event whose schedule goes on to its next event before the
+    // writes are done.  The principal must first be taken from the
+    // schedule, and kept alive until writeDoneTask runs.
+    void
+    writeEventInBackground(hep::concurrency::WaitingTaskPtr const writeDoneTask,
+                           EventPrincipal& ep)
+    {
+      epExec_.writeEventInBackground(writeDoneTask, ep);
+    }
+
+    std::unique_ptr<EventPrincipal>
+    take_event_principal()
+    {
+      assert(eventPrincipal_);
+      return std::move(eventPrincipal_);
+    }
+
+    void
+    release_event_principal()
+    {
       // Delete principal
       eventPrincipal_.reset();
     }
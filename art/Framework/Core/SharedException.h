@@ -40,6 +40,14 @@ namespace art {
       store(std::make_exception_ptr(T{std::forward<Args>(args)...}));
     }
 
+    // May be called from any thread, e.g. to stop taking new work
+    // once an exception has been stored.
+    bool
+    has_stored_exception() const
+    {
+      return cachedExceptionStored_.load();
+    }
+
     void
     throw_if_stored_exception()
     {
@@ -0,0 +1,22 @@
+#ifndef art_Framework_Core_TransitionWorkers_h
+#define art_Framework_Core_TransitionWorkers_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// TransitionWorkers selects which workers take part in a run or
+// subrun transition.  Normally all of them do.  When subrun
+// transitions are pipelined (see the 'pipelineSubRuns' scheduler
+// parameter), the replicated workers of a schedule are driven when
+// that schedule moves on to the next subrun, whereas the shared
+// workers are driven once every schedule has left the subrun.
+// ====================================================================
+
+namespace art {
+  enum class TransitionWorkers { All, Replicated, Shared };
+} // namespace art
+
+#endif /* art_Framework_Core_TransitionWorkers_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -157,11 +157,16 @@ namespace art {
   }
 
   void
-  TriggerPathsExecutor::process(Transition const trans, Principal& principal)
+  TriggerPathsExecutor::process(Transition const trans,
+                                Principal& principal,
+                                TransitionWorkers const which)
   {
     triggerPathsInfo_.reset();
+    // The on-demand producers go first, as the modules on the paths
+    // may consume their run and subrun products.
+    triggerPathsInfo_.onDemandWorkers().process(trans, principal, which);
     for (auto& path : triggerPathsInfo_.paths()) {
-      path.process(trans, principal);
+      path.process(trans, principal, which);
     }
   }
 
@@ -216,7 +221,8 @@ namespace art {
     // We get here as part of the readAndProcessEventTask (schedule
     // head task).
     actReg_.sPreProcessEvent.invoke(
-      event_principal.makeEvent(ModuleContext::invalid()), sc_);
+      std::as_const(event_principal).makeEvent(ModuleContext::invalid()),
+      sc_);
     auto const scheduleID = sc_.id();
     TDEBUG_BEGIN_FUNC_SI(4, scheduleID);
     if (results_inserter_) {
@@ -268,7 +274,8 @@ namespace art {
         PathContext const pc{sc_,
                              PathContext::art_path_spec(),
                              {resultsInserterDesc.moduleLabel()}};
-        ModuleContext const mc{pc, resultsInserterDesc};
+        ModuleContext const mc{
+          pc, resultsInserterDesc, results_inserter_->slotLayout()};
         results_inserter_->doWork_event(principal, mc);
       }
     }
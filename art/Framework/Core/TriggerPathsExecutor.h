@@ -24,6 +24,7 @@
 // independent of the Path objects.
 // ======================================================================
 
+#include "art/Framework/Core/TransitionWorkers.h"
 #include "art/Framework/Core/fwd.h"
 #include "art/Framework/Principal/Worker.h"
 #include "art/Framework/Principal/fwd.h"
@@ -55,7 +56,9 @@ namespace art {
     TriggerPathsExecutor& operator=(TriggerPathsExecutor&&) = delete;
 
     // API presented to EventProcessor
-    void process(Transition, Principal&);
+    void process(Transition,
+                 Principal&,
+                 TransitionWorkers = TransitionWorkers::All);
     void process_event(hep::concurrency::WaitingTaskPtr endPathTask,
                        EventPrincipal&);
     void beginJob(detail::SharedResources const& resources);
@@ -1,6 +1,7 @@
 #include "art/Framework/Core/WorkerInPath.h"
 // vim: set sw=2 expandtab :
 
+#include "art/Framework/Core/OnDemandWorkers.h"
 #include "art/Framework/Principal/Worker.h"
 #include "art/Framework/Principal/fwd.h"
 #include "art/Utilities/GlobalTaskGroup.h"
@@ -20,10 +21,18 @@ namespace art {
                              GlobalTaskGroup& taskGroup)
     : worker_{w}
     , filterAction_{fa}
-    , moduleContext_{pc, w->description()}
+    , moduleContext_{pc, w->description(), w->slotLayout()}
     , taskGroup_{&taskGroup}
   {}
 
+  void
+  WorkerInPath::runAfter(cet::exempt_ptr<OnDemandWorkers> onDemandWorkers,
+                         vector<size_t> onDemandIndices)
+  {
+    onDemandWorkers_ = onDemandWorkers;
+    onDemandIndices_ = std::move(onDemandIndices);
+  }
+
   Worker*
   WorkerInPath::getWorker() const
   {
@@ -126,6 +135,46 @@ namespace art {
     GlobalTaskGroup* taskGroup_;
   };
 
+  // Runs the worker once the on-demand workers it depends on have
+  // finished.
+  class WorkerInPath::RunWorkerTask {
+  public:
+    RunWorkerTask(WorkerInPath* wip,
+                  WaitingTaskPtr workerInPathDoneTask,
+                  EventPrincipal& ep)
+      : wip_{wip}
+      , workerInPathDoneTask_{std::move(workerInPathDoneTask)}
+      , ep_{ep}
+    {}
+
+    void
+    operator()(exception_ptr const ex) const
+    {
+      auto const sid = wip_->moduleContext_.scheduleID();
+      TDEBUG_BEGIN_TASK_SI(4, sid);
+      if (ex) {
+        // The worker is not run, and the exception of the on-demand
+        // worker is reported as its own.
+        wip_->taskGroup_->may_run(workerInPathDoneTask_, ex);
+        TDEBUG_END_TASK_SI(4, sid) << "because of EXCEPTION";
+        return;
+      }
+      try {
+        wip_->worker_->doWork_event(
+          workerInPathDoneTask_, ep_, wip_->moduleContext_);
+      }
+      catch (...) {
+        wip_->taskGroup_->may_run(workerInPathDoneTask_, current_exception());
+      }
+      TDEBUG_END_TASK_SI(4, sid);
+    }
+
+  private:
+    WorkerInPath* wip_;
+    WaitingTaskPtr workerInPathDoneTask_;
+    EventPrincipal& ep_;
+  };
+
   void
   WorkerInPath::run(WaitingTaskPtr workerDoneTask, EventPrincipal& ep)
   {
@@ -135,7 +184,16 @@ namespace art {
     try {
       auto workerInPathDoneTask = make_waiting_task<WorkerInPathDoneTask>(
         this, scheduleID, workerDoneTask, taskGroup_);
-      worker_->doWork_event(workerInPathDoneTask, ep, moduleContext_);
+      if (onDemandIndices_.empty()) {
+        worker_->doWork_event(workerInPathDoneTask, ep, moduleContext_);
+      } else {
+        auto runWorkerTask =
+          make_waiting_task(RunWorkerTask{this, workerInPathDoneTask, ep},
+                            onDemandIndices_.size());
+        for (auto const idx : onDemandIndices_) {
+          onDemandWorkers_->run(idx, runWorkerTask, ep);
+        }
+      }
     }
     catch (...) {
       ++counts_thrown_;
@@ -20,9 +20,12 @@
 #include "cetlib/exempt_ptr.h"
 #include "hep_concurrency/WaitingTask.h"
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace art {
+  class OnDemandWorkers;
   using module_label_t = std::string;
 
   namespace detail {
@@ -50,6 +53,11 @@ namespace art {
     Worker* getWorker() const;
     detail::FilterAction filterAction() const;
 
+    // Run the given on-demand workers, whose products the worker
+    // consumes, before the worker itself is run for an event.
+    void runAfter(cet::exempt_ptr<OnDemandWorkers>,
+                  std::vector<std::size_t> onDemandIndices);
+
     // Used only by Path
     bool returnCode() const;
     bool run(Transition, Principal&);
@@ -64,11 +72,14 @@ namespace art {
 
   private:
     class WorkerInPathDoneTask;
+    class RunWorkerTask;
 
     cet::exempt_ptr<Worker> worker_;
     detail::FilterAction filterAction_;
     ModuleContext moduleContext_;
     GlobalTaskGroup* taskGroup_;
+    cet::exempt_ptr<OnDemandWorkers> onDemandWorkers_{nullptr};
+    std::vector<std::size_t> onDemandIndices_{};
 
     // Per-schedule
     bool returnCode_{false};
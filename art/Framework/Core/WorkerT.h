@@ -61,6 +61,7 @@ namespace art {
         // copy.
         module_->fillProductDescriptions();
       }
+      setSlotLayout(module_->slotLayout());
     }
 
     // Register shared resources only once
@@ -11,11 +11,13 @@ namespace art::detail {
     keytype_for_name_t&& enabled_modules,
     module_entries_for_ordered_path_t&& trigger_paths,
     module_entries_for_ordered_path_t&& end_paths,
+    std::vector<std::string>&& on_demand_modules,
     bool const trigger_paths_override,
     bool const end_paths_override)
     : enabledModules_{std::move(enabled_modules)}
     , triggerPaths_{std::move(trigger_paths)}
     , endPaths_{std::move(end_paths)}
+    , onDemandModules_{std::move(on_demand_modules)}
     , triggerPathsOverride_{trigger_paths_override}
     , endPathsOverride_{end_paths_override}
   {}
@@ -13,6 +13,7 @@ namespace art::detail {
     explicit EnabledModules(keytype_for_name_t&& enabled_modules,
                             module_entries_for_ordered_path_t&& trigger_paths,
                             module_entries_for_ordered_path_t&& end_paths,
+                            std::vector<std::string>&& on_demand_modules,
                             bool trigger_paths_override,
                             bool end_paths_override);
 
@@ -47,11 +48,19 @@ namespace art::detail {
       return endPaths_;
     }
 
+    // Sorted labels of the producers that are run on demand.
+    std::vector<std::string> const&
+    on_demand_modules() const noexcept
+    {
+      return onDemandModules_;
+    }
+
   private:
     EnabledModules() = default;
     keytype_for_name_t enabledModules_{};
     module_entries_for_ordered_path_t triggerPaths_{};
     module_entries_for_ordered_path_t endPaths_{};
+    std::vector<std::string> onDemandModules_{};
     bool triggerPathsOverride_{false};
     bool endPathsOverride_{false};
   };
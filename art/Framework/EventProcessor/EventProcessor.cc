@@ -7,15 +7,23 @@
 #include "art/Framework/Core/InputSourceDescription.h"
 #include "art/Framework/Core/InputSourceFactory.h"
 #include "art/Framework/Core/InputSourceMutex.h"
+#include "art/Framework/Core/OutputWorker.h"
 #include "art/Framework/Core/ReplicatedProducer.h"
 #include "art/Framework/EventProcessor/detail/writeSummary.h"
 #include "art/Framework/Principal/ClosedRangeSetHandler.h"
 #include "art/Framework/Principal/ConsumesInfo.h"
 #include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/EventArenaPool.h"
 #include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/GroupPool.h"
+#include "art/Framework/Principal/ProductEviction.h"
+#include "art/Framework/Principal/ProductTableIndex.h"
+#include "art/Framework/Principal/ProductTokenCache.h"
 #include "art/Framework/Principal/RangeSetHandler.h"
 #include "art/Framework/Principal/Run.h"
 #include "art/Framework/Principal/RunPrincipal.h"
+#include "art/Framework/Principal/SecondaryFileIndex.h"
+#include "art/Framework/Principal/SelectorMatchCache.h"
 #include "art/Framework/Principal/SubRun.h"
 #include "art/Framework/Principal/SubRunPrincipal.h"
 #include "art/Framework/Services/Optional/RandomNumberGenerator.h"
@@ -46,11 +54,14 @@
 #include "hep_concurrency/WaitingTask.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
 #include <cassert>
 #include <exception>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -82,7 +93,13 @@ namespace art {
     auto const invalid_module_context = ModuleContext::invalid();
   }
 
-  EventProcessor::~EventProcessor() = default;
+  EventProcessor::~EventProcessor()
+  {
+    // The pooled groups refer to product descriptions that belong to
+    // the input source.
+    GroupPool::instance()->setCapacity(0);
+    EventArenaPool::instance()->setCapacity(0);
+  }
 
   EventProcessor::EventProcessor(ParameterSet pset,
                                  detail::EnabledModules enabled_modules)
@@ -100,6 +117,9 @@ namespace art {
                    std::move(enabled_modules)}
     , handleEmptyRuns_{scheduler_->handleEmptyRuns()}
     , handleEmptySubRuns_{scheduler_->handleEmptySubRuns()}
+    , pipelineSubRuns_{scheduler_->pipelineSubRuns()}
+    , readAheadDepth_{scheduler_->readAheadDepth()}
+    , writesInFlight_{scheduler_->writesInFlight()}
   {
     auto services_pset = pset.get<ParameterSet>("services");
     auto const scheduler_pset = services_pset.get<ParameterSet>("scheduler");
@@ -154,8 +174,14 @@ namespace art {
     ProcessConfiguration const pc{processName, pset.id(), getReleaseVersion()};
     auto const producing_services = servicesManager_->registerProducts(
       producedProductDescriptions_, psSignals_, pc);
+    PathManager::WorkerOptions worker_options;
+    worker_options.runModulesByDependencies =
+      scheduler_->runModulesByDependencies();
+    worker_options.prefetchConsumedProducts =
+      scheduler_->prefetchConsumedProducts();
+    worker_options.evictConsumedProducts = scheduler_->evictConsumedProducts();
     pathManager_->createModulesAndWorkers(
-      *taskGroup_, sharedResources_, producing_services);
+      *taskGroup_, sharedResources_, producing_services, worker_options);
 
     ServiceHandle<TriggerNamesService> trigger_names [[maybe_unused]];
     auto const end = Globals::instance()->nschedules();
@@ -179,6 +205,20 @@ namespace art {
                                                 *taskGroup_));
     }
     sharedResources_.freeze(taskGroup_->native_group());
+    if (pipelineSubRuns_ && readAheadDepth_ != 0u) {
+      throw Exception{errors::Configuration}
+        << "The 'pipelineSubRuns' and 'readAheadDepth' scheduler parameters\n"
+        << "cannot be used together.\n";
+    }
+    if (pipelineSubRuns_ && writesInFlight_ != 0u) {
+      throw Exception{errors::Configuration}
+        << "The 'pipelineSubRuns' and 'writesInFlight' scheduler parameters\n"
+        << "cannot be used together.\n";
+    }
+    if (pipelineSubRuns_) {
+      verifyPipelinedSubRunsAllowed();
+      adoptedSubRunSeq_.expand_to_num_schedules();
+    }
 
     FDEBUG(2) << pset.to_string() << endl;
     // The input source must be created after the end path executor
@@ -230,6 +270,12 @@ namespace art {
     // Create product tables used for product retrieval within modules.
     producedProductLookupTables_ = ProductTables{producedProductDescriptions_};
     outputCallbacks_->invoke(producedProductLookupTables_);
+    // At most one event principal per schedule, per read-ahead event
+    // and per background write is alive at any time.
+    auto const maxEventPrincipals =
+      scheduler_->num_schedules() + readAheadDepth_ + writesInFlight_;
+    GroupPool::instance()->setCapacity(maxEventPrincipals);
+    EventArenaPool::instance()->setCapacity(maxEventPrincipals);
   }
 
   void
@@ -248,6 +294,43 @@ namespace art {
     actReg_.sPostBeginJobWorkers.invoke(input_, allWorkers);
   }
 
+  void
+  EventProcessor::verifyPipelinedSubRunsAllowed()
+  {
+    // A shared module sees the events of all schedules, so it cannot
+    // be told that a subrun has ended while events of that subrun are
+    // still being processed elsewhere.  Output modules are exempt:
+    // they are told of subrun transitions only once every schedule
+    // has finished with the subrun.
+    vector<string> offending;
+    auto collect_offending = [&offending](auto const& workers) {
+      for (auto const& [label, worker] : workers) {
+        if (worker->description().moduleThreadingType() ==
+            ModuleThreadingType::replicated) {
+          continue;
+        }
+        if (dynamic_cast<OutputWorker const*>(worker.get())) {
+          continue;
+        }
+        offending.push_back(label);
+      }
+    };
+    collect_offending(
+      pathManager_->triggerPathsInfo(ScheduleID::first()).workers());
+    collect_offending(pathManager_->endPathInfo(ScheduleID::first()).workers());
+    if (offending.empty()) {
+      return;
+    }
+    Exception e{errors::Configuration};
+    e << "The 'pipelineSubRuns' scheduler parameter requires that all\n"
+      << "modules other than output modules be replicated.  The following\n"
+      << "modules are not:\n";
+    for (auto const& label : offending) {
+      e << "  " << label << '\n';
+    }
+    throw e;
+  }
+
   //================================================================
   // Event-loop infrastructure
 
@@ -317,6 +400,12 @@ namespace art {
     assert(runPrincipal_);
     assert(runPrincipal_->runID().isValid());
     readSubRun();
+    scheduleIteration_.for_each_schedule([this](ScheduleID const sid) {
+      schedule(sid).seedSubRunRangeSet(*currentSubRunRSH_);
+      if (pipelineSubRuns_) {
+        adoptedSubRunSeq_[sid] = currentSubRunSeq_;
+      }
+    });
 
     // We only enable subrun finalization if reading was successful.
     // This appears to be a design weakness.
@@ -471,6 +560,8 @@ namespace art {
   EventProcessor::endJob()
   {
     FDEBUG(1) << string(8, ' ') << "endJob\n";
+    // Output files may still be being finished in the background.
+    ec_->call([this] { taskGroup_->native_group().wait(); });
     ec_->call([this] { endJobAllSchedules(); });
     ec_->call([] { ConsumesInfo::instance()->showMissingConsumes(); });
     ec_->call([this] { input_->doEndJob(); });
@@ -479,6 +570,16 @@ namespace art {
     ec_->call([this] {
       detail::writeSummary(pathManager_, scheduler_->wantSummary(), timer_);
     });
+    if (readAheadDepth_ != 0u && scheduler_->wantSummary()) {
+      ec_->call([this] { reportReadAhead(); });
+    }
+    if (writesInFlight_ != 0u && scheduler_->wantSummary()) {
+      ec_->call([this] { reportBackgroundWrites(); });
+    }
+    if (scheduler_->wantSummary() &&
+        EventArenaPool::instance()->statistics().created != 0u) {
+      ec_->call([] { reportEventArenas(); });
+    }
   }
 
   void
@@ -502,6 +603,15 @@ namespace art {
         << "Source readFile() did not return a valid FileBlock: FileBlock "
         << "should be valid or readFile() should throw.\n";
     }
+    // Products retrieved through tokens must be looked up again in
+    // the product tables of the new file, whose groups cannot be
+    // reused from those of the previous one.
+    ProductTokenCache::instance()->invalidate();
+    SecondaryFileIndex::instance()->invalidate();
+    SelectorMatchCache::instance()->invalidate();
+    ProductTableIndex::instance()->invalidate();
+    ProductEviction::instance()->invalidate();
+    GroupPool::instance()->clear();
     actReg_.sPostOpenFile.invoke(fb_->fileName());
     respondToOpenInputFile();
   }
@@ -811,12 +921,11 @@ namespace art {
     actReg_.sPreSourceSubRun.invoke();
     subRunPrincipal_.reset(input_->readSubRun(runPrincipal_.get()).release());
     assert(subRunPrincipal_);
-    auto rsh = input_->subRunRangeSetHandler();
-    assert(rsh);
-    auto seed_range_set = [this, &rsh](ScheduleID const sid) {
-      schedule(sid).seedSubRunRangeSet(*rsh);
-    };
-    scheduleIteration_.for_each_schedule(seed_range_set);
+    // The schedules are seeded with the range-set handler by the
+    // caller.
+    currentSubRunRSH_ = input_->subRunRangeSetHandler();
+    assert(currentSubRunRSH_);
+    ++currentSubRunSeq_;
     // The intended behavior here is that the producing services which
     // are called during the sPostReadSubRun cannot see each others
     // put products. We enforce this by creating the groups for the
@@ -1031,6 +1140,154 @@ namespace art {
               << ")\n";
   }
 
+  //=============================================
+  // Pipelined subrun transitions
+  //
+  // When the 'pipelineSubRuns' scheduler parameter is set, a schedule
+  // that encounters a subrun boundary within a run reads the new
+  // subrun itself (with the input source lock held) and carries on,
+  // instead of ending event processing so that the main thread can
+  // perform the transition once every schedule has drained.  The
+  // superseded subrun is retired: each schedule ends it for its
+  // replicated modules when it next reads an event, and once every
+  // schedule has left it, the first schedule ends it for the output
+  // modules and writes it.  All of the functions below must be called
+  // with the input source lock held, or when no events are being
+  // processed.
+
+  bool
+  EventProcessor::pipelineSubRunTransition()
+  {
+    if (!pipelineSubRuns_ || main_schedule().outputsToClose()) {
+      return false;
+    }
+    assert(subRunPrincipal_);
+    if (subRunPrincipal_->subRunID().isFlush()) {
+      return false;
+    }
+    retiringSubRuns_.push_back(RetiringSubRun{currentSubRunSeq_,
+                                              move(subRunPrincipal_),
+                                              move(currentSubRunRSH_),
+                                              RangeSet::invalid(),
+                                              scheduler_->num_schedules()});
+    readSubRun();
+    // The replicated modules are told of the new subrun as each
+    // schedule adopts it, and the output modules when its predecessor
+    // is finalized.
+    beginSubRunCalled_ = true;
+    FDEBUG(1) << string(8, ' ') << "pipelineSubRun..............("
+              << subRunPrincipal_->subRunID() << ")\n";
+    return true;
+  }
+
+  void
+  EventProcessor::adoptCurrentSubRun(ScheduleID const sid)
+  {
+    if (adoptedSubRunSeq_[sid] == currentSubRunSeq_) {
+      return;
+    }
+    leaveRetiringSubRuns(sid);
+    auto& sched = schedule(sid);
+    sched.seedSubRunRangeSet(*currentSubRunRSH_);
+    if (!subRunPrincipal_->subRunID().isFlush()) {
+      sched.process(Transition::BeginSubRun,
+                    *subRunPrincipal_,
+                    TransitionWorkers::Replicated);
+    }
+    adoptedSubRunSeq_[sid] = currentSubRunSeq_;
+  }
+
+  void
+  EventProcessor::leaveRetiringSubRuns(ScheduleID const sid)
+  {
+    auto& sched = schedule(sid);
+    auto const adopted = adoptedSubRunSeq_[sid];
+    for (auto& sr : retiringSubRuns_) {
+      if (sr.seq < adopted) {
+        // Already left.
+        continue;
+      }
+      if (sr.seq == adopted) {
+        auto const& rsh = sched.subRunRangeSetHandler();
+        if (rsh.type() == RangeSetHandler::HandlerType::Open) {
+          auto const& rs = rsh.seenRanges();
+          // The following constructor ensures that the range is
+          // sorted before 'merge' is called.
+          RangeSet const tmp{rs.run(), rs.ranges()};
+          sr.seenRanges.merge(tmp);
+        }
+      } else {
+        // This schedule did not process any events of this subrun.
+        sched.process(Transition::BeginSubRun,
+                      *sr.principal,
+                      TransitionWorkers::Replicated);
+      }
+      sched.process(
+        Transition::EndSubRun, *sr.principal, TransitionWorkers::Replicated);
+      assert(sr.remaining != 0);
+      --sr.remaining;
+    }
+  }
+
+  void
+  EventProcessor::finalizeRetiredSubRuns()
+  {
+    while (!retiringSubRuns_.empty() &&
+           retiringSubRuns_.front().remaining == 0) {
+      auto sr = move(retiringSubRuns_.front());
+      retiringSubRuns_.pop_front();
+      auto& principal = *sr.principal;
+      std::lock_guard sentry{outputMutex_};
+      openSomeOutputFiles();
+      if (sr.rangeSetHandler->type() == RangeSetHandler::HandlerType::Open) {
+        principal.updateSeenRanges(sr.seenRanges);
+        scheduleIteration_.for_each_schedule([this, &sr](ScheduleID const sid) {
+          schedule(sid).setSubRunAuxiliaryRangeSetID(sr.seenRanges);
+        });
+      } else {
+        // The subrun is complete, so all of its ranges have been seen.
+        sr.rangeSetHandler->flushRanges();
+        auto const seen = sr.rangeSetHandler->seenRanges();
+        principal.updateSeenRanges(seen);
+        main_schedule().setSubRunAuxiliaryRangeSetID(seen);
+      }
+      actReg_.sPreEndSubRun.invoke(principal.subRunID(), principal.endTime());
+      main_schedule().process(
+        Transition::EndSubRun, principal, TransitionWorkers::Shared);
+      actReg_.sPostEndSubRun.invoke(
+        std::as_const(principal).makeSubRun(invalid_module_context));
+      main_schedule().writeSubRun(principal);
+      main_schedule().recordOutputClosureRequests(Granularity::SubRun);
+      FDEBUG(1) << string(8, ' ') << "finalizeRetiredSubRun.......("
+                << principal.subRunID() << ")\n";
+
+      // Now the output modules may be told of the successor.
+      auto& next = retiringSubRuns_.empty() ?
+                     *subRunPrincipal_ :
+                     *retiringSubRuns_.front().principal;
+      if (next.subRunID().isFlush()) {
+        continue;
+      }
+      auto const srun = std::as_const(next).makeSubRun(invalid_module_context);
+      actReg_.sPreBeginSubRun.invoke(srun);
+      main_schedule().process(
+        Transition::BeginSubRun, next, TransitionWorkers::Shared);
+      actReg_.sPostBeginSubRun.invoke(srun);
+    }
+  }
+
+  void
+  EventProcessor::catchUpPipelinedSubRuns()
+  {
+    if (!pipelineSubRuns_) {
+      return;
+    }
+    scheduleIteration_.for_each_schedule(
+      [this](ScheduleID const sid) { adoptCurrentSubRun(sid); });
+    finalizeRetiredSubRuns();
+    assert(retiringSubRuns_.empty());
+  }
+
   // ==============================================================================
   // Event level
 
@@ -1060,7 +1317,12 @@ namespace art {
       // If anything bad happened during event processing, let the
       // user know.
       sharedException_.throw_if_stored_exception();
+      // Finish any subruns whose transitions were pipelined, so that
+      // the current subrun can be finalized as usual.
+      catchUpPipelinedSubRuns();
       if (!fileSwitchInProgress_.load()) {
+        // Events read ahead of a shutdown are not processed.
+        readAheadQueue_.clear();
         done = true;
         continue;
       }
@@ -1069,10 +1331,9 @@ namespace art {
       respondToCloseOutputFiles();
       main_schedule().closeSomeOutputFiles();
       FDEBUG(1) << string(8, ' ') << "closeSomeOutputFiles\n";
-      // We started the switch after advancing to the next item type;
-      // we must make sure that we read that event before advancing
-      // the item type again.
-      firstEvent_ = true;
+      // A switch started after advancing to the next event has set
+      // firstEvent_ (see advanceAndReadEvent), so that event is read
+      // before the item type is advanced again.
       fileSwitchInProgress_ = false;
     }
   }
@@ -1120,89 +1381,48 @@ namespace art {
       TDEBUG_END_FUNC_SI(4, sid) << "CLEAN SHUTDOWN";
       return;
     }
+    if (sharedException_.has_stored_exception()) {
+      // An event of another schedule failed (possibly while being
+      // written in the background); no further events are taken.
+      TDEBUG_END_FUNC_SI(4, sid) << "EXCEPTION";
+      return;
+    }
 
-    // The item type advance and the event read must be done with the
-    // input source lock held; however event-processing must not
-    // serialized.
-    {
-      InputSourceMutexSentry lock_input;
+    if (readAheadDepth_ != 0u) {
+      // Events may already have been read, so a pending file switch
+      // must be noticed before taking one.  The events that have been
+      // read ahead are processed after the switch.
       if (fileSwitchInProgress_.load()) {
-        // We must avoid advancing the iterator after a schedule has
-        // noticed it is time to switch files.  After the switch, we
-        // will need to set firstEvent_ true so that the first
-        // schedule that resumes after the switch actually reads the
-        // event that the first schedule which noticed we needed a
-        // switch had advanced the iterator to.
-
-        // Note: We still have the problem that because the schedules
-        // do not read events at the same time the file switch point
-        // can be up to nschedules-1 ahead of where it would have been
-        // if there was only one schedule.  If we are switching output
-        // files every event in an attempt to create single event
-        // files, this really does not work out too well.
         TDEBUG_END_FUNC_SI(4, sid) << "FILE SWITCH";
         return;
       }
-      // Check the next item type and exit this task if it is not an
-      // event, or if the user has asynchronously requested a
-      // shutdown.
-      auto expected = true;
-      if (firstEvent_.compare_exchange_strong(expected, false)) {
-        // Do not advance the item type on the first event.
-      } else {
-        // Do the advance item type.
-        if (nextLevel_.load() == Level::ReadyToAdvance) {
-          // See what the next item is.
-          TDEBUG_FUNC_SI(5, sid) << "Calling advanceItemType()";
-          nextLevel_ = advanceItemType();
-        }
-        if ((nextLevel_.load() < most_deeply_nested_level()) ||
-            (nextLevel_.load() == highest_level())) {
-          // We are popping up, end event processing and this task.
-          TDEBUG_END_FUNC_SI(4, sid) << "END OF SUBRUN";
-          return;
-        }
-        if (nextLevel_.load() != most_deeply_nested_level()) {
-          // Error: incorrect level hierarchy
-          TDEBUG_END_FUNC_SI(4, sid) << "BAD HIERARCHY";
-          throw Exception{errors::LogicError} << "Incorrect level hierarchy.";
-        }
-        nextLevel_ = Level::ReadyToAdvance;
-        // At this point we have determined that we are going to read
-        // an event and we must do that before dropping the lock on
-        // the input source which is what is protecting us against a
-        // double-advance caused by a different schedule.
-        if (schedule(sid).outputsToClose()) {
-          fileSwitchInProgress_ = true;
-          TDEBUG_END_FUNC_SI(4, sid) << "FILE SWITCH INITIATED";
-          return;
-        }
+      if (schedule(sid).outputsToClose()) {
+        fileSwitchInProgress_ = true;
+        // The source is kept busy while the other schedules drain, so
+        // that every schedule has an event to take once the output
+        // files have been switched.
+        startReadAhead();
+        TDEBUG_END_FUNC_SI(4, sid) << "FILE SWITCH INITIATED";
+        return;
       }
+    }
 
-      // Now we can read the event from the source.
-      ScheduleContext const sc{sid};
-      assert(subRunPrincipal_);
-      assert(subRunPrincipal_->subRunID().isValid());
-      actReg_.sPreSourceEvent.invoke(sc);
-      TDEBUG_FUNC_SI(5, sid) << "Calling input_->readEvent(subRunPrincipal_)";
-      auto ep = input_->readEvent(subRunPrincipal_.get());
-      assert(ep);
-      // The intended behavior here is that the producing services
-      // which are called during the sPostReadEvent cannot see each
-      // others put products.  We enforce this by creating the groups
-      // for the produced products, but do not allow the lookups to
-      // find them until after the callbacks have run.
-      ep->createGroupsForProducedProducts(producedProductLookupTables_);
-      psSignals_->sPostReadEvent.invoke(*ep);
-      ep->enableLookupOfProducedProducts();
-      actReg_.sPostSourceEvent.invoke(
-        std::as_const(*ep).makeEvent(invalid_module_context), sc);
-      FDEBUG(1) << string(8, ' ') << "readEvent...................("
-                << ep->eventID() << ")\n";
-      schedule(sid).accept_principal(std::move(ep));
+    // The item type advance and the event read must be done with the
+    // input source lock held; however event-processing must not
+    // serialized.
+    if (!takeReadAheadEvent(sid)) {
+      InputSourceMutexSentry lock_input;
+      // An event may have been read ahead while we were waiting for
+      // the lock.
+      if (!takeReadAheadEvent(sid) && !advanceAndReadEvent(sid)) {
+        TDEBUG_END_FUNC_SI(4, sid);
+        return;
+      }
       // Now we drop the input source lock by exiting the guarded
       // scope.
     }
+    startReadAhead();
+
     if (schedule(sid).event_principal().eventID().isFlush()) {
       // No processing to do, start next event handling task.
       processAllEventsAsync(sid);
@@ -1215,6 +1435,245 @@ namespace art {
     TDEBUG_END_FUNC_SI(4, sid);
   }
 
+  // Called with the input source lock held.  Advances to the next
+  // item and, if it is an event, reads it for the given schedule.
+  // Returns false if the schedule is not to process another event.
+  bool
+  EventProcessor::advanceAndReadEvent(ScheduleID const sid)
+  {
+    if (fileSwitchInProgress_.load()) {
+      // We must avoid advancing the iterator after a schedule has
+      // noticed it is time to switch files.  The schedule which
+      // noticed we needed a switch has set firstEvent_ true, so that
+      // the event it had advanced the iterator to is still read.
+
+      // Note: We still have the problem that because the schedules
+      // do not read events at the same time the file switch point
+      // can be up to nschedules-1 ahead of where it would have been
+      // if there was only one schedule.  If we are switching output
+      // files every event in an attempt to create single event
+      // files, this really does not work out too well.
+      TDEBUG_FUNC_SI(5, sid) << "FILE SWITCH";
+      return false;
+    }
+    // Check the next item type and exit this task if it is not an
+    // event, or if the user has asynchronously requested a
+    // shutdown.
+    auto expected = true;
+    if (firstEvent_.compare_exchange_strong(expected, false)) {
+      // Do not advance the item type on the first event.
+    } else {
+      // Do the advance item type.
+      if (nextLevel_.load() == Level::ReadyToAdvance) {
+        // See what the next item is.
+        TDEBUG_FUNC_SI(5, sid) << "Calling advanceItemType()";
+        nextLevel_ = advanceItemType();
+      }
+      while ((nextLevel_.load() == Level::SubRun) &&
+             pipelineSubRunTransition()) {
+        TDEBUG_FUNC_SI(5, sid) << "Calling advanceItemType()";
+        nextLevel_ = advanceItemType();
+      }
+      if ((nextLevel_.load() < most_deeply_nested_level()) ||
+          (nextLevel_.load() == highest_level())) {
+        // We are popping up, end event processing and this task.
+        TDEBUG_FUNC_SI(5, sid) << "END OF SUBRUN";
+        return false;
+      }
+      if (nextLevel_.load() != most_deeply_nested_level()) {
+        // Error: incorrect level hierarchy
+        TDEBUG_FUNC_SI(5, sid) << "BAD HIERARCHY";
+        throw Exception{errors::LogicError} << "Incorrect level hierarchy.";
+      }
+      nextLevel_ = Level::ReadyToAdvance;
+      // At this point we have determined that we are going to read
+      // an event and we must do that before dropping the lock on
+      // the input source which is what is protecting us against a
+      // double-advance caused by a different schedule.
+      if (schedule(sid).outputsToClose()) {
+        // We have advanced to an event that we do not read.  It must
+        // be read before the item type is advanced again: after the
+        // switch or, when reading ahead, by the read-ahead task while
+        // the schedules drain.  Background writes may request a
+        // switch at any time, so this can happen even though reading
+        // ahead normally starts a switch before advancing.
+        firstEvent_ = true;
+        fileSwitchInProgress_ = true;
+        TDEBUG_FUNC_SI(5, sid) << "FILE SWITCH INITIATED";
+        return false;
+      }
+    }
+
+    if (pipelineSubRuns_) {
+      adoptCurrentSubRun(sid);
+      if (sid == ScheduleID::first()) {
+        // The first schedule is not processing an event right now,
+        // so its end path may be used to drive the output modules.
+        finalizeRetiredSubRuns();
+      }
+    }
+
+    // Now we can read the event from the source.
+    ScheduleContext const sc{sid};
+    assert(subRunPrincipal_);
+    assert(subRunPrincipal_->subRunID().isValid());
+    actReg_.sPreSourceEvent.invoke(sc);
+    TDEBUG_FUNC_SI(5, sid) << "Calling readEventPrincipal()";
+    auto ep = readEventPrincipal();
+    if (readAheadDepth_ != 0u) {
+      std::lock_guard sentry{readAheadMutex_};
+      ++readAheadCounters_.readBySchedules;
+    }
+    actReg_.sPostSourceEvent.invoke(
+      std::as_const(*ep).makeEvent(invalid_module_context), sc);
+    FDEBUG(1) << string(8, ' ') << "readEvent...................("
+              << ep->eventID() << ")\n";
+    schedule(sid).accept_principal(std::move(ep));
+    return true;
+  }
+
+  std::unique_ptr<EventPrincipal>
+  EventProcessor::readEventPrincipal()
+  {
+    auto ep = input_->readEvent(subRunPrincipal_.get());
+    assert(ep);
+    // The intended behavior here is that the producing services
+    // which are called during the sPostReadEvent cannot see each
+    // others put products.  We enforce this by creating the groups
+    // for the produced products, but do not allow the lookups to
+    // find them until after the callbacks have run.
+    ep->createGroupsForProducedProducts(producedProductLookupTables_);
+    psSignals_->sPostReadEvent.invoke(*ep);
+    ep->enableLookupOfProducedProducts();
+    return ep;
+  }
+
+  // ==============================================================================
+  // Event read-ahead
+
+  bool
+  EventProcessor::takeReadAheadEvent(ScheduleID const sid)
+  {
+    if (readAheadDepth_ == 0u) {
+      return false;
+    }
+    std::unique_ptr<EventPrincipal> ep;
+    {
+      std::lock_guard sentry{readAheadMutex_};
+      auto& counters = readAheadCounters_;
+      auto const occupancy = readAheadQueue_.size();
+      ++counters.samples;
+      counters.occupancySum += occupancy;
+      counters.maxOccupancy = max(counters.maxOccupancy, occupancy);
+      if (occupancy == 0u) {
+        return false;
+      }
+      ep = move(readAheadQueue_.front());
+      readAheadQueue_.pop_front();
+      ++counters.taken;
+    }
+    // The source signals are emitted on behalf of the schedule which
+    // processes the event.
+    ScheduleContext const sc{sid};
+    actReg_.sPreSourceEvent.invoke(sc);
+    actReg_.sPostSourceEvent.invoke(
+      std::as_const(*ep).makeEvent(invalid_module_context), sc);
+    FDEBUG(1) << string(8, ' ') << "readEvent (ahead)...........("
+              << ep->eventID() << ")\n";
+    schedule(sid).accept_principal(move(ep));
+    return true;
+  }
+
+  void
+  EventProcessor::startReadAhead()
+  {
+    if (readAheadDepth_ == 0u || readAheadActive_.exchange(true)) {
+      return;
+    }
+    taskGroup_->run([this] { readAhead(); });
+  }
+
+  // Fills the read-ahead queue until it is full, or until the next
+  // item is not an event.  In the latter case the item is left for
+  // the schedules, which end their event loops upon seeing it.
+  //
+  // Reading goes on while the schedules drain for an output-file
+  // switch: the events read are only processed, and written to the
+  // new files, after the switch.  The events that were being
+  // processed when the switch was initiated are written to the old
+  // files.  The switch itself waits for this task, as for all tasks
+  // of the event loop, so no event is read while the output files
+  // are being closed.
+  void
+  EventProcessor::readAhead()
+  {
+    try {
+      InputSourceMutexSentry lock_input;
+      while (shutdown_flag == 0) {
+        {
+          std::lock_guard sentry{readAheadMutex_};
+          if (readAheadQueue_.size() >= readAheadDepth_) {
+            break;
+          }
+        }
+        auto expected = true;
+        if (!firstEvent_.compare_exchange_strong(expected, false)) {
+          if (nextLevel_.load() == Level::ReadyToAdvance) {
+            nextLevel_ = advanceItemType();
+          }
+          if (nextLevel_.load() != most_deeply_nested_level()) {
+            break;
+          }
+          nextLevel_ = Level::ReadyToAdvance;
+        }
+        auto ep = readEventPrincipal();
+        std::lock_guard sentry{readAheadMutex_};
+        readAheadQueue_.push_back(move(ep));
+        ++readAheadCounters_.read;
+      }
+    }
+    catch (...) {
+      sharedException_.store_current();
+    }
+    readAheadActive_ = false;
+  }
+
+  void
+  EventProcessor::reportReadAhead() const
+  {
+    auto const& counters = readAheadCounters_;
+    auto const meanOccupancy =
+      counters.samples == 0u ?
+        0. :
+        static_cast<double>(counters.occupancySum) / counters.samples;
+    mf::LogPrint("ArtSummary") << "";
+    mf::LogPrint("ArtSummary")
+      << "ReadAhead ---------- Event read-ahead summary ------------";
+    mf::LogPrint("ArtSummary")
+      << "ReadAhead Events read ahead = " << counters.read
+      << " taken from queue = " << counters.taken
+      << " read by schedules = " << counters.readBySchedules;
+    mf::LogPrint("ArtSummary")
+      << "ReadAhead Queue depth = " << readAheadDepth_
+      << " mean occupancy = " << fixed << setprecision(2)
+      << meanOccupancy << " max occupancy = " << counters.maxOccupancy;
+  }
+
+  void
+  EventProcessor::reportEventArenas()
+  {
+    auto const stats = EventArenaPool::instance()->statistics();
+    mf::LogPrint("ArtSummary") << "";
+    mf::LogPrint("ArtSummary")
+      << "EventArena ---------- Event memory-arena summary ----------";
+    mf::LogPrint("ArtSummary")
+      << "EventArena Arenas created = " << stats.created
+      << " reused = " << stats.reused;
+    mf::LogPrint("ArtSummary")
+      << "EventArena Largest event (bytes) = " << stats.highWaterMark
+      << " largest arena (bytes) = " << stats.largestCapacity;
+  }
+
   // ----------------------------------------------------------------------------
   class EventProcessor::EndPathRunnerTask {
   public:
@@ -1408,6 +1867,197 @@ namespace art {
     TDEBUG_END_FUNC_SI(4, sid) << "terminate event loop because of EXCEPTION";
   }
 
+  class EventProcessor::WriteDoneTask {
+  public:
+    WriteDoneTask(EventProcessor* evp, ScheduleID const sid)
+      : evp_{evp}, sid_{sid}
+    {}
+
+    void
+    operator()(exception_ptr const ex) const
+    {
+      // Note: When we start our parent is the write queue of the
+      // output module that finished writing last.
+      TDEBUG_BEGIN_TASK_SI(4, sid_);
+      auto& schedule = evp_->schedule(sid_);
+      FDEBUG(1) << string(8, ' ') << "writeEvent..................("
+                << schedule.event_principal().eventID() << ")\n";
+      schedule.release_event_principal();
+      if (ex) {
+        try {
+          rethrow_exception(ex);
+        }
+        catch (cet::exception& e) {
+          if (evp_->error_action(e) != actions::IgnoreCompletely) {
+            evp_->sharedException_.store<Exception>(
+              errors::EventProcessorFailure,
+              "EventProcessor: an exception occurred "
+              "during current event processing",
+              e);
+            TDEBUG_END_TASK_SI(4, sid_) << "EXCEPTION";
+            return;
+          }
+          mf::LogWarning(e.category())
+            << "exception being ignored for current event:\n"
+            << cet::trim_right_copy(e.what(), " \n");
+          // WARNING: We continue processing after the catch blocks!!!
+        }
+        catch (...) {
+          mf::LogError("PassingThrough")
+            << "an exception occurred during current event processing";
+          evp_->sharedException_.store_current();
+          TDEBUG_END_TASK_SI(4, sid_) << "EXCEPTION";
+          return;
+        }
+      }
+
+      // The next event processing task is a continuation of this task.
+      evp_->processAllEventsAsync(sid_);
+      TDEBUG_END_TASK_SI(4, sid_);
+    }
+
+  private:
+    EventProcessor* evp_;
+    ScheduleID const sid_;
+  };
+
+  class EventProcessor::BackgroundWriteDoneTask {
+  public:
+    BackgroundWriteDoneTask(EventProcessor* evp,
+                            std::unique_ptr<EventPrincipal> ep)
+      : evp_{evp}, ep_{move(ep)}
+    {}
+
+    void
+    operator()(exception_ptr const ex)
+    {
+      // Note: When we start our parent is the write queue of the
+      // output module that finished writing last.  The schedule that
+      // processed the event has moved on; the event principal is
+      // owned by this task.
+      FDEBUG(1) << string(8, ' ') << "writeEvent (background)......("
+                << ep_->eventID() << ")\n";
+      ep_.reset();
+      if (ex) {
+        // The range sets of the output files already cover the event
+        // (see EndPathExecutor::writeEventInBackground), so a failed
+        // write cannot be ignored: it always ends the job.
+        try {
+          rethrow_exception(ex);
+        }
+        catch (cet::exception& e) {
+          evp_->sharedException_.store<Exception>(
+            errors::EventProcessorFailure,
+            "EventProcessor: an exception occurred "
+            "during current event processing",
+            e);
+        }
+        catch (...) {
+          mf::LogError("PassingThrough")
+            << "an exception occurred during current event processing";
+          evp_->sharedException_.store_current();
+        }
+      }
+      // A waiting schedule is resumed even after a failure, so that
+      // its event loop can notice the exception and end.
+      evp_->backgroundWriteDone();
+    }
+
+  private:
+    EventProcessor* evp_;
+    std::unique_ptr<EventPrincipal> ep_;
+  };
+
+  // Unless 'writesInFlight' events are already being written, hands
+  // the event of the schedule over to a background write, and goes on
+  // to the next event right away.  Otherwise the schedule waits, still
+  // holding its event, until one of the writes is done; it is that
+  // write which then starts the write of the waiting schedule.  The
+  // number of events in flight therefore never exceeds the limit.
+  void
+  EventProcessor::writeEventInBackground(ScheduleID const sid)
+  {
+    {
+      std::lock_guard sentry{backgroundWritesMutex_};
+      auto& writes = backgroundWrites_;
+      if (writes.inFlight == writesInFlight_) {
+        writes.waitingSchedules.push_back(sid);
+        ++writes.waits;
+        TDEBUG_FUNC_SI(5, sid) << "WAITING FOR BACKGROUND WRITES";
+        return;
+      }
+      ++writes.inFlight;
+      writes.maxInFlight = max(writes.maxInFlight, writes.inFlight);
+    }
+    startBackgroundWrite(sid);
+  }
+
+  // Called once a place among the writes in flight has been taken for
+  // the event of the schedule.  The schedule then goes on to its next
+  // event, which is a continuation of this task.
+  void
+  EventProcessor::startBackgroundWrite(ScheduleID const sid)
+  {
+    if (sharedException_.has_stored_exception()) {
+      // The job is failing; the event is dropped rather than written.
+      schedule(sid).release_event_principal();
+      backgroundWriteDone();
+    } else {
+      auto ep = schedule(sid).take_event_principal();
+      auto& principal = *ep;
+      auto writeDoneTask =
+        make_waiting_task<BackgroundWriteDoneTask>(this, move(ep));
+      try {
+        schedule(sid).writeEventInBackground(writeDoneTask, principal);
+        std::lock_guard sentry{backgroundWritesMutex_};
+        ++backgroundWrites_.written;
+      }
+      catch (...) {
+        mf::LogError("PassingThrough")
+          << "an exception occurred during current event processing";
+        sharedException_.store_current();
+        backgroundWriteDone();
+      }
+    }
+    processAllEventsAsync(sid);
+  }
+
+  // Gives the place of a finished write to the first waiting
+  // schedule, if there is one.
+  void
+  EventProcessor::backgroundWriteDone()
+  {
+    optional<ScheduleID> sid;
+    {
+      std::lock_guard sentry{backgroundWritesMutex_};
+      auto& writes = backgroundWrites_;
+      if (writes.waitingSchedules.empty()) {
+        --writes.inFlight;
+      } else {
+        sid = writes.waitingSchedules.front();
+        writes.waitingSchedules.pop_front();
+      }
+    }
+    if (sid) {
+      startBackgroundWrite(*sid);
+    }
+  }
+
+  void
+  EventProcessor::reportBackgroundWrites() const
+  {
+    auto const& writes = backgroundWrites_;
+    mf::LogPrint("ArtSummary") << "";
+    mf::LogPrint("ArtSummary")
+      << "BackgroundWrites ---------- Background write summary ----------";
+    mf::LogPrint("ArtSummary")
+      << "BackgroundWrites Events written = " << writes.written
+      << " max in flight = " << writes.maxInFlight << " (limit "
+      << writesInFlight_ << ")";
+    mf::LogPrint("ArtSummary")
+      << "BackgroundWrites Schedule waits for writes = " << writes.waits;
+  }
+
   void
   EventProcessor::finishEventAsync(ScheduleID const sid)
   {
@@ -1425,27 +2075,32 @@ namespace art {
       // if so setup to end the job the next time around the event
       // loop.
       FDEBUG(1) << string(8, ' ') << "shouldWeStop\n";
-      static std::mutex m;
-      std::lock_guard sentry{m};
       // Now we can write the results of processing to the outputs,
       // and delete the event principal.
       if (!ep.eventID().isFlush()) {
-        // Possibly open new output files.  This is safe to do because
-        // EndPathExecutor functions are called in a serialized
-        // context.
-        TDEBUG_FUNC_SI(5, sid) << "Calling openSomeOutputFiles()";
-        openSomeOutputFiles();
+        {
+          // Possibly open new output files.  Only one schedule may
+          // do so at a time.
+          std::lock_guard sentry{outputMutex_};
+          TDEBUG_FUNC_SI(5, sid) << "Calling openSomeOutputFiles()";
+          openSomeOutputFiles();
+        }
+        if (writesInFlight_ != 0u) {
+          TDEBUG_FUNC_SI(5, sid) << "Calling writeEventInBackground()";
+          writeEventInBackground(sid);
+          TDEBUG_END_FUNC_SI(4, sid);
+          return;
+        }
         TDEBUG_FUNC_SI(5, sid) << "Calling schedule(sid).writeEvent()";
-
-        auto const id = ep.eventID();
-        schedule(sid).writeEvent();
-        FDEBUG(1) << string(8, ' ') << "writeEvent..................(" << id
-                  << ")\n";
+        // The next event processing task is a continuation of the
+        // writes.
+        schedule(sid).writeEvent(make_waiting_task<WriteDoneTask>(this, sid));
+        TDEBUG_END_FUNC_SI(4, sid);
+        return;
       }
-      TDEBUG_FUNC_SI(5, sid)
-        << "Calling schedules_->"
-           "recordOutputClosureRequests(Granularity::Event)";
-      schedule(sid).recordOutputClosureRequests(Granularity::Event);
+      // Flush events are not written, and so they cannot change
+      // whether an output module wants to close its file.
+      schedule(sid).release_event_principal();
     }
     catch (cet::exception& e) {
       if (error_action(e) != actions::IgnoreCompletely) {
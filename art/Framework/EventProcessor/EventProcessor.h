@@ -20,6 +20,7 @@
 #include "art/Framework/EventProcessor/detail/ExceptionCollector.h"
 #include "art/Framework/Principal/Actions.h"
 #include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/RangeSetHandler.h"
 #include "art/Framework/Principal/RunPrincipal.h"
 #include "art/Framework/Principal/SubRunPrincipal.h"
 #include "art/Framework/Principal/fwd.h"
@@ -31,12 +32,16 @@
 #include "art/Utilities/ScheduleIteration.h"
 #include "art/Utilities/SharedResource.h"
 #include "canvas/Persistency/Provenance/ProductTables.h"
+#include "canvas/Persistency/Provenance/RangeSet.h"
 #include "cetlib/cpu_timer.h"
 #include "fhiclcpp/fwd.h"
 #include "hep_concurrency/thread_sanitize.h"
 
 #include <atomic>
+#include <cstddef>
+#include <deque>
 #include <memory>
+#include <mutex>
 
 namespace art {
 
@@ -76,6 +81,8 @@ namespace art {
   private:
     class EndPathTask;
     class EndPathRunnerTask;
+    class WriteDoneTask;
+    class BackgroundWriteDoneTask;
 
     // Event-loop infrastructure
     void processAllEventsAsync(ScheduleID sid);
@@ -132,6 +139,30 @@ namespace art {
     void processEvent();
     void writeEvent();
     void setOutputFileStatus(OutputFileStatus);
+
+    // Pipelined subrun transitions
+    void verifyPipelinedSubRunsAllowed();
+    bool pipelineSubRunTransition();
+    void adoptCurrentSubRun(ScheduleID sid);
+    void leaveRetiringSubRuns(ScheduleID sid);
+    void finalizeRetiredSubRuns();
+    void catchUpPipelinedSubRuns();
+
+    // Event read-ahead
+    bool advanceAndReadEvent(ScheduleID sid);
+    std::unique_ptr<EventPrincipal> readEventPrincipal();
+    bool takeReadAheadEvent(ScheduleID sid);
+    void startReadAhead();
+    void readAhead();
+    void reportReadAhead() const;
+
+    // Background event writes
+    void writeEventInBackground(ScheduleID sid);
+    void startBackgroundWrite(ScheduleID sid);
+    void backgroundWriteDone();
+    void reportBackgroundWrites() const;
+    static void reportEventArenas();
+
     void invokePostBeginJobWorkers_();
     void terminateAbnormally_();
 
@@ -239,8 +270,10 @@ namespace art {
     // The currently active RunPrincipal.
     tsan_unique_ptr<RunPrincipal> runPrincipal_{nullptr};
 
-    // The currently active SubRunPrincipal.
-    tsan_unique_ptr<SubRunPrincipal> subRunPrincipal_{nullptr};
+    // The currently active SubRunPrincipal.  It is reference counted
+    // so that, when subrun transitions are pipelined, a superseded
+    // subrun stays alive until every schedule has finished with it.
+    std::shared_ptr<SubRunPrincipal> subRunPrincipal_{nullptr};
 
     // The currently active EventPrincipals.
     PerScheduleContainer<std::unique_ptr<EventPrincipal>> eventPrincipals_{};
@@ -251,6 +284,77 @@ namespace art {
     // Are we configured to process empty subruns?
     bool const handleEmptySubRuns_;
 
+    // A subrun that has been superseded by a pipelined subrun
+    // transition, but which has not yet been finalized.
+    struct RetiringSubRun {
+      std::size_t seq;
+      std::shared_ptr<SubRunPrincipal> principal;
+      std::unique_ptr<RangeSetHandler> rangeSetHandler;
+      // Merged from the schedules as they leave the subrun.
+      RangeSet seenRanges{RangeSet::invalid()};
+      // The number of schedules that have not yet left the subrun.
+      ScheduleID::size_type remaining;
+    };
+
+    // Are subrun transitions pipelined?
+    bool const pipelineSubRuns_;
+
+    // Pipelined subrun bookkeeping, all of which is protected by the
+    // input source mutex.  Subruns are numbered in the order they are
+    // read; each schedule remembers the number of the subrun for
+    // which its replicated modules last received a beginSubRun.
+    std::size_t currentSubRunSeq_{};
+    std::unique_ptr<RangeSetHandler> currentSubRunRSH_{nullptr};
+    std::deque<RetiringSubRun> retiringSubRuns_{};
+    PerScheduleContainer<std::size_t> adoptedSubRunSeq_{};
+
+    // The maximum number of events read ahead of the schedules; 0
+    // disables reading ahead.
+    unsigned const readAheadDepth_;
+
+    // Events that have been read ahead, in the order in which they
+    // were read.  Events are only added with the input source mutex
+    // held, but they are taken without it.
+    std::deque<std::unique_ptr<EventPrincipal>> readAheadQueue_{};
+
+    // Is a read-ahead task running?
+    std::atomic<bool> readAheadActive_{false};
+
+    // Occupancy of the read-ahead queue, for the job summary.  The
+    // queue occupancy is sampled whenever a schedule looks for an
+    // event.
+    struct ReadAheadCounters {
+      std::size_t read{};
+      std::size_t taken{};
+      std::size_t readBySchedules{};
+      std::size_t samples{};
+      std::size_t occupancySum{};
+      std::size_t maxOccupancy{};
+    };
+    ReadAheadCounters readAheadCounters_{};
+
+    // Protects the read-ahead queue and its counters.
+    std::mutex readAheadMutex_{};
+
+    // The maximum number of events written in the background; 0
+    // disables background writes.
+    unsigned const writesInFlight_;
+
+    // The number of events whose writes have not finished, and the
+    // schedules that wait, still holding their events, for one of
+    // those writes to finish.  The counters are for the job summary.
+    struct BackgroundWrites {
+      unsigned inFlight{};
+      std::deque<ScheduleID> waitingSchedules{};
+      std::size_t written{};
+      std::size_t waits{};
+      unsigned maxInFlight{};
+    };
+    BackgroundWrites backgroundWrites_{};
+
+    // Protects backgroundWrites_.
+    std::mutex backgroundWritesMutex_{};
+
     // Used to communicate exceptions from worker threads to the main
     // thread.
     SharedException sharedException_;
@@ -264,6 +368,10 @@ namespace art {
 
     // Are we current switching output files?
     std::atomic<bool> fileSwitchInProgress_{false};
+
+    // Serializes the opening of output files.  Event writes do not
+    // need it; they are serialized per output module instead.
+    std::mutex outputMutex_{};
   };
 
 } // namespace art
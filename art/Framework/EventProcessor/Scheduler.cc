@@ -53,9 +53,15 @@ namespace art {
     , stackSize_{ps().stack_size()}
     , handleEmptyRuns_{ps().handleEmptyRuns()}
     , handleEmptySubRuns_{ps().handleEmptySubRuns()}
+    , pipelineSubRuns_{ps().pipelineSubRuns()}
+    , readAheadDepth_{ps().readAheadDepth()}
+    , writesInFlight_{ps().writesInFlight()}
     , errorOnMissingConsumes_{ps().errorOnMissingConsumes()}
     , wantSummary_{ps().wantSummary()}
     , dataDependencyGraph_{ps().dataDependencyGraph()}
+    , runModulesByDependencies_{ps().runModulesByDependencies()}
+    , prefetchConsumedProducts_{ps().prefetchConsumedProducts()}
+    , evictConsumedProducts_{ps().evictConsumedProducts()}
   {
     auto& globals = *Globals::instance();
     globals.setNThreads(nThreads_);
@@ -45,6 +45,47 @@ namespace art {
         10 * mb()};
       fhicl::Atom<bool> handleEmptyRuns{Name{"handleEmptyRuns"}, true};
       fhicl::Atom<bool> handleEmptySubRuns{Name{"handleEmptySubRuns"}, true};
+      fhicl::Atom<bool> pipelineSubRuns{
+        Name{"pipelineSubRuns"},
+        Comment{
+          "If true, schedules do not wait for one another at subrun\n"
+          "boundaries within a run: events of the next subrun may be\n"
+          "processed while the remaining events of the previous subrun\n"
+          "finish.  Replicated modules receive their subrun transitions\n"
+          "per schedule, and output modules are told of the end of a\n"
+          "subrun once every schedule has finished with it.  All\n"
+          "non-output modules must be replicated to use this mode."},
+        false};
+      fhicl::Atom<unsigned> readAheadDepth{
+        Name{"readAheadDepth"},
+        Comment{
+          "The maximum number of events that are read from the input\n"
+          "source ahead of time, so that a schedule which finishes an event\n"
+          "can pick up the next one without waiting for the source.  A\n"
+          "value of 0 disables reading ahead.  For events that have been\n"
+          "read ahead, the pre- and post-source-event signals are emitted\n"
+          "when a schedule takes the event, and so do not bracket the read\n"
+          "itself.  Events are also read ahead while the schedules finish\n"
+          "their events for an output-file switch, so that processing\n"
+          "resumes at once after the switch.  Reading ahead cannot be\n"
+          "combined with 'pipelineSubRuns'."},
+        0u};
+      fhicl::Atom<unsigned> writesInFlight{
+        Name{"writesInFlight"},
+        Comment{
+          "The maximum number of events that may still be written to the\n"
+          "output modules after their schedules have gone on to process\n"
+          "the next event.  A schedule that would exceed this number waits\n"
+          "until one of the writes is done.  A value of 0 disables writing\n"
+          "in the background: each schedule waits for its own event to be\n"
+          "written.  An output module is asked whether to close its file\n"
+          "only once an event has been written, so a file may receive up\n"
+          "to this number of events more than its closing criteria (e.g.\n"
+          "'fileProperties.maxEvents') allow, in addition to the events\n"
+          "that the other schedules are processing.  A failed background\n"
+          "write always ends the job.  Background writes cannot be\n"
+          "combined with 'pipelineSubRuns'."},
+        0u};
       fhicl::Atom<bool> errorOnMissingConsumes{Name{"errorOnMissingConsumes"},
                                                false};
       fhicl::Atom<bool> errorOnSIGINT{Name{"errorOnSIGINT"}, true};
@@ -53,6 +94,34 @@ namespace art {
       fhicl::Atom<bool> reportUnused{Name{"reportUnused"}, true};
       fhicl::Atom<std::string> dataDependencyGraph{Name{"dataDependencyGraph"},
                                                    {}};
+      fhicl::Atom<bool> runModulesByDependencies{
+        Name{"runModulesByDependencies"},
+        Comment{
+          "If true, each module on a trigger path is run as soon as the\n"
+          "modules on that path whose products it consumes, and every\n"
+          "filter before it on the path, have finished.  Otherwise, the\n"
+          "modules on a trigger path are run one at a time, in path order.\n"
+          "All data-product dependencies must be declared with 'consumes'\n"
+          "statements for this to be safe."},
+        false};
+      fhicl::Atom<bool> prefetchConsumedProducts{
+        Name{"prefetchConsumedProducts"},
+        Comment{
+          "If true, the event products from the input file that a module\n"
+          "consumes (by type and input tag) are read in parallel before\n"
+          "the module is run, rather than one at a time when the module\n"
+          "retrieves them.  A product that is consumed but not retrieved\n"
+          "is then read nonetheless."},
+        false};
+      fhicl::Atom<bool> evictConsumedProducts{
+        Name{"evictConsumedProducts"},
+        Comment{
+          "If true, an event product read from the input file is removed\n"
+          "from the event as soon as all modules that consume it have run\n"
+          "for that event, unless an output module writes it.  All\n"
+          "data-product dependencies must be declared with 'consumes'\n"
+          "statements for this to be safe."},
+        false};
       struct DebugConfig {
         fhicl::Atom<std::string> fileName{Name{"fileName"}};
         fhicl::Atom<std::string> option{Name{"option"}};
@@ -96,6 +165,21 @@ namespace art {
       return handleEmptySubRuns_;
     }
     bool
+    pipelineSubRuns() const noexcept
+    {
+      return pipelineSubRuns_;
+    }
+    unsigned
+    readAheadDepth() const noexcept
+    {
+      return readAheadDepth_;
+    }
+    unsigned
+    writesInFlight() const noexcept
+    {
+      return writesInFlight_;
+    }
+    bool
     errorOnMissingConsumes() const noexcept
     {
       return errorOnMissingConsumes_;
@@ -110,6 +194,21 @@ namespace art {
     {
       return dataDependencyGraph_;
     }
+    bool
+    runModulesByDependencies() const noexcept
+    {
+      return runModulesByDependencies_;
+    }
+    bool
+    prefetchConsumedProducts() const noexcept
+    {
+      return prefetchConsumedProducts_;
+    }
+    bool
+    evictConsumedProducts() const noexcept
+    {
+      return evictConsumedProducts_;
+    }
 
     std::unique_ptr<GlobalTaskGroup> global_task_group();
 
@@ -122,9 +221,15 @@ namespace art {
     unsigned const stackSize_;
     bool const handleEmptyRuns_;
     bool const handleEmptySubRuns_;
+    bool const pipelineSubRuns_;
+    unsigned const readAheadDepth_;
+    unsigned const writesInFlight_;
     bool const errorOnMissingConsumes_;
     bool const wantSummary_;
     std::string const dataDependencyGraph_;
+    bool const runModulesByDependencies_;
+    bool const prefetchConsumedProducts_;
+    bool const evictConsumedProducts_;
   };
 }
 
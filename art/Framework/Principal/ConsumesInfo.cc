@@ -9,7 +9,12 @@
 #include "cetlib/container_algorithms.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <cstdlib>
+#include <memory>
+#include <optional>
 #include <set>
 
 using namespace std;
@@ -104,20 +109,79 @@ namespace art {
     array<vector<ProductInfo>, NumBranchTypes> const& consumables)
   {
     std::lock_guard sentry{mutex_};
+    // Once sealed, the consumes information is read without locking.
+    assert(!sealed_.load());
     consumables_.emplace(module_label, consumables);
   }
 
   void
+  ConsumesInfo::sealConsumes()
+  {
+    std::lock_guard sentry{mutex_};
+    sealedConsumables_.clear();
+    size_t next{};
+    for (auto const& [module_label, consumables] : consumables_) {
+      SealedConsumables sealed{&consumables, {}};
+      for (size_t bt = 0; bt != NumBranchTypes; ++bt) {
+        sealed.firstIndex[bt] = next;
+        next += consumables[bt].size();
+      }
+      sealedConsumables_.emplace(module_label, sealed);
+    }
+    numConsumables_ = next;
+    sealed_ = true;
+  }
+
+  ConsumesInfo::SealedConsumables const*
+  ConsumesInfo::sealedConsumables(string const& module_label) const
+  {
+    // A module without consumes information is treated as one that
+    // consumes nothing.
+    static consumables_t::mapped_type const nothing{};
+    static SealedConsumables const none{&nothing, {}};
+    if (!sealed_.load()) {
+      return nullptr;
+    }
+    auto it = sealedConsumables_.find(module_label);
+    return it != sealedConsumables_.cend() ? &it->second : &none;
+  }
+
+  size_t
+  ConsumesInfo::numConsumables() const
+  {
+    return sealed_.load() ? numConsumables_ : 0;
+  }
+
+  optional<size_t>
   ConsumesInfo::validateConsumedProduct(BranchType const bt,
                                         ModuleDescription const& md,
                                         ProductInfo const& productInfo)
   {
+    return validateConsumedProduct(
+      bt, md, productInfo, sealedConsumables(md.moduleLabel()));
+  }
 
-    std::lock_guard sentry{mutex_};
-    if (cet::binary_search_all(consumables_[md.moduleLabel()][bt],
-                               productInfo)) {
-      // Found it, everything is ok.
-      return;
+  optional<size_t>
+  ConsumesInfo::validateConsumedProduct(BranchType const bt,
+                                        ModuleDescription const& md,
+                                        ProductInfo const& productInfo,
+                                        SealedConsumables const* const sealed)
+  {
+    if (sealed != nullptr) {
+      auto const& consumables = (*sealed->consumables)[bt];
+      auto it = lower_bound(
+        consumables.cbegin(), consumables.cend(), productInfo);
+      if (it != consumables.cend() && !(productInfo < *it)) {
+        // Found it, everything is ok.
+        return sealed->firstIndex[bt] + (it - consumables.cbegin());
+      }
+    } else {
+      std::lock_guard sentry{mutex_};
+      auto it = consumables_.find(md.moduleLabel());
+      if (it != consumables_.cend() &&
+          cet::binary_search_all(it->second[bt], productInfo)) {
+        return nullopt;
+      }
     }
     if (requireConsumes_.load()) {
       throw Exception(errors::ProductRegistrationFailure,
@@ -127,14 +191,48 @@ namespace art {
         << module_context(md) << ":\n\n"
         << "  " << assemble_consumes_statement(bt, productInfo) << "\n\n";
     }
-    missingConsumes_[md.moduleLabel()][bt].insert(productInfo);
+    auto& buffer = missingConsumesBuffer();
+    std::lock_guard sentry{buffer.mutex};
+    buffer.missing[md.moduleLabel()][bt].insert(productInfo);
+    return nullopt;
+  }
+
+  ConsumesInfo::MissingConsumesBuffer&
+  ConsumesInfo::missingConsumesBuffer()
+  {
+    // The buffers are owned by the (only) ConsumesInfo object, so
+    // that they outlive the threads that filled them.
+    thread_local MissingConsumesBuffer* buffer{nullptr};
+    if (buffer == nullptr) {
+      std::lock_guard sentry{mutex_};
+      buffer = missingConsumesBuffers_
+                 .emplace_back(make_unique<MissingConsumesBuffer>())
+                 .get();
+    }
+    return *buffer;
+  }
+
+  ConsumesInfo::missing_consumes_t
+  ConsumesInfo::missingConsumes() const
+  {
+    missing_consumes_t result;
+    std::lock_guard sentry{mutex_};
+    for (auto const& buffer : missingConsumesBuffers_) {
+      std::lock_guard buffer_sentry{buffer->mutex};
+      for (auto const& [modLabel, arySetPI] : buffer->missing) {
+        auto& merged = result[modLabel];
+        for (size_t i = 0; i != arySetPI.size(); ++i) {
+          merged[i].insert(cbegin(arySetPI[i]), cend(arySetPI[i]));
+        }
+      }
+    }
+    return result;
   }
 
   void
   ConsumesInfo::showMissingConsumes() const
   {
-    std::lock_guard sentry{mutex_};
-    for (auto const& [modLabel, arySetPI] : missingConsumes_) {
+    for (auto const& [modLabel, arySetPI] : missingConsumes()) {
       constexpr cet::HorizontalRule rule{60};
       mf::LogPrint log{"MTdiagnostics"};
       log << '\n'
@@ -74,8 +74,11 @@
 
 #include <array>
 #include <atomic>
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -112,23 +115,76 @@ namespace art {
       return consumables_.at(module_label);
     }
 
+    // Must be called before the consumes information is sealed.
     void collectConsumes(std::string const& module_label,
                          consumables_t::mapped_type const& consumables);
 
-    // This is used by get*() in ProductRetriever.
-    void validateConsumedProduct(BranchType const,
-                                 ModuleDescription const&,
-                                 ProductInfo const& productInfo);
+    // The consumes information of one module, once sealed.  Each
+    // consumes statement of each module is given a dense index,
+    // unique within the job: the index of consumables[bt][i] is
+    // firstIndex[bt] + i.
+    struct SealedConsumables {
+      consumables_t::mapped_type const* consumables;
+      std::array<std::size_t, NumBranchTypes> firstIndex;
+    };
+
+    // Called once all modules have been constructed.  From then on,
+    // the consumes information is read without locking, and no more
+    // can be collected.
+    void sealConsumes();
+
+    // Used by ProductRetriever so that the consumes information of
+    // its module is looked up once, rather than for each retrieval.
+    // Returns null if the information has not been sealed.
+    SealedConsumables const* sealedConsumables(
+      std::string const& module_label) const;
+
+    // The number of consumes statements of all modules, once sealed.
+    std::size_t numConsumables() const;
+
+    // This is used by get*() in ProductRetriever.  If the consumes
+    // information is sealed and the product has been declared, the
+    // index of its consumes statement is returned.
+    std::optional<std::size_t> validateConsumedProduct(
+      BranchType const,
+      ModuleDescription const&,
+      ProductInfo const& productInfo);
+    std::optional<std::size_t> validateConsumedProduct(
+      BranchType const,
+      ModuleDescription const&,
+      ProductInfo const& productInfo,
+      SealedConsumables const* sealed);
+
+    // Maps module label to the per-branch products that were
+    // retrieved without having been declared.
+    using missing_consumes_t =
+      std::map<std::string const,
+               std::array<std::set<ProductInfo>, NumBranchTypes>>;
 
+    // The missing consumes statements recorded by all threads.
+    missing_consumes_t missingConsumes() const;
     void showMissingConsumes() const;
 
   private:
     ConsumesInfo();
 
-    // Protects access to consumables_ and missingConsumes_.
+    // The missing consumes statements seen by one thread.  Each
+    // thread records into its own buffer; the buffers are merged by
+    // showMissingConsumes.
+    struct MissingConsumesBuffer {
+      // Only contended while the buffers are being merged.
+      std::mutex mutex{};
+      missing_consumes_t missing{};
+    };
+
+    MissingConsumesBuffer& missingConsumesBuffer();
+
+    // Protects access to consumables_ (until it is sealed) and to
+    // missingConsumesBuffers_.
     mutable std::recursive_mutex mutex_{};
 
     std::atomic<bool> requireConsumes_;
+    std::atomic<bool> sealed_{false};
 
     // Maps module label to run, per-branch consumes info.  Note that
     // there is only one entry per module label.  This is intentional
@@ -136,10 +192,13 @@ namespace art {
     // replicated module object.
     consumables_t consumables_;
 
-    // Maps module label to run, per-branch missing product consumes info.
-    std::map<std::string const,
-             std::array<std::set<ProductInfo>, NumBranchTypes>>
-      missingConsumes_;
+    // Filled by sealConsumes.
+    std::map<std::string const, SealedConsumables> sealedConsumables_;
+    std::size_t numConsumables_{};
+
+    // The per-thread records of missing consumes statements.
+    std::vector<std::unique_ptr<MissingConsumesBuffer>>
+      missingConsumesBuffers_;
   };
 } // namespace art
 
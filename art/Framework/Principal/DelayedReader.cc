@@ -2,10 +2,53 @@
 #include "art/Framework/Principal/Principal.h"
 // vim: set sw=2 expandtab :
 
+#include "art/Framework/Principal/Group.h"
+#include "art/Utilities/GlobalTaskGroup.h"
 #include "canvas/Persistency/Provenance/ProductProvenance.h"
 
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+using namespace hep::concurrency;
 using namespace std;
 
+namespace {
+  class ReadProductTask {
+  public:
+    ReadProductTask(cet::exempt_ptr<art::Group const> group,
+                    shared_ptr<atomic<size_t>> pending,
+                    WaitingTaskPtr doneTask,
+                    art::GlobalTaskGroup& taskGroup)
+      : group_{group}
+      , pending_{std::move(pending)}
+      , doneTask_{std::move(doneTask)}
+      , taskGroup_{taskGroup}
+    {}
+
+    void
+    operator()() const
+    {
+      try {
+        group_->resolveProductIfAvailable();
+      }
+      catch (...) {
+        // The module retrieving the product will see the failure.
+      }
+      // The last read to finish notifies the done task.
+      if (--*pending_ == 0u) {
+        taskGroup_.may_run(doneTask_);
+      }
+    }
+
+  private:
+    cet::exempt_ptr<art::Group const> group_;
+    shared_ptr<atomic<size_t>> pending_;
+    WaitingTaskPtr doneTask_;
+    art::GlobalTaskGroup& taskGroup_;
+  };
+}
+
 namespace art {
 
   DelayedReader::DelayedReader() = default;
@@ -22,9 +65,16 @@ namespace art {
   void
   DelayedReader::setPrincipal(cet::exempt_ptr<Principal> principal)
   {
+    principal_ = principal;
     setPrincipal_(principal);
   }
 
+  cet::exempt_ptr<Principal const>
+  DelayedReader::principal() const
+  {
+    return principal_;
+  }
+
   void
   DelayedReader::setPrincipal_(cet::exempt_ptr<Principal>)
   {}
@@ -41,6 +91,18 @@ namespace art {
     return {};
   }
 
+  bool
+  DelayedReader::readsProvenanceConcurrently() const
+  {
+    return readsProvenanceConcurrently_();
+  }
+
+  bool
+  DelayedReader::readsProvenanceConcurrently_() const
+  {
+    return false;
+  }
+
   bool
   DelayedReader::isAvailableAfterCombine(ProductID pid) const
   {
@@ -65,4 +127,27 @@ namespace art {
     return nullptr;
   }
 
+  void
+  DelayedReader::prefetchAsync(vector<cet::exempt_ptr<Group const>> groups,
+                               WaitingTaskPtr doneTask,
+                               GlobalTaskGroup& taskGroup) const
+  {
+    if (groups.empty()) {
+      taskGroup.may_run(doneTask);
+      return;
+    }
+    prefetchAsync_(std::move(groups), std::move(doneTask), taskGroup);
+  }
+
+  void
+  DelayedReader::prefetchAsync_(vector<cet::exempt_ptr<Group const>> groups,
+                                WaitingTaskPtr doneTask,
+                                GlobalTaskGroup& taskGroup) const
+  {
+    auto pending = make_shared<atomic<size_t>>(groups.size());
+    for (auto const group : groups) {
+      taskGroup.run(ReadProductTask{group, pending, doneTask, taskGroup});
+    }
+  }
+
 } // namespace art
@@ -10,10 +10,12 @@
 //
 
 #include "art/Framework/Principal/fwd.h"
+#include "art/Utilities/fwd.h"
 #include "canvas/Persistency/Common/EDProduct.h"
 #include "canvas/Persistency/Provenance/ProductID.h"
 #include "canvas/Persistency/Provenance/fwd.h"
 #include "cetlib/exempt_ptr.h"
+#include "hep_concurrency/WaitingTask.h"
 
 #include <memory>
 #include <vector>
@@ -29,18 +31,45 @@ namespace art {
                                           ProductID,
                                           RangeSet&) const;
     void setPrincipal(cet::exempt_ptr<Principal>);
+    cet::exempt_ptr<Principal const> principal() const;
     std::vector<ProductProvenance> readProvenance() const;
+    // Whether readProvenance may be called without the input source
+    // lock, while products of the same file are being read by other
+    // tasks.  If so, the provenance of event products is read only
+    // when it is first needed; otherwise, it is read when the
+    // principal is made.  The default is false.
+    bool readsProvenanceConcurrently() const;
     bool isAvailableAfterCombine(ProductID) const;
+    // Reads the entry of the principal from the first secondary file,
+    // from index idx on, that holds it, and leaves idx one past that
+    // file's index.  Returns null if no remaining file holds it.
     std::unique_ptr<Principal> readFromSecondaryFile(int& idx);
 
+    // Reads the products of the given groups ahead of their
+    // retrieval, and notifies doneTask once all of them have been
+    // read.  A product that cannot be read is skipped; the failure
+    // is reported when the product is retrieved.
+    void prefetchAsync(std::vector<cet::exempt_ptr<Group const>> groups,
+                       hep::concurrency::WaitingTaskPtr doneTask,
+                       GlobalTaskGroup&) const;
+
   private:
     virtual std::unique_ptr<EDProduct> getProduct_(Group const*,
                                                    ProductID,
                                                    RangeSet&) const = 0;
     virtual void setPrincipal_(cet::exempt_ptr<Principal>);
     virtual std::vector<ProductProvenance> readProvenance_() const;
+    virtual bool readsProvenanceConcurrently_() const;
     virtual bool isAvailableAfterCombine_(ProductID) const;
     virtual std::unique_ptr<Principal> readFromSecondaryFile_(int& idx);
+    // By default, each product is read in its own task so that the
+    // products are read in parallel.  A reader that can only read
+    // one product at a time should override this.
+    virtual void prefetchAsync_(std::vector<cet::exempt_ptr<Group const>>,
+                                hep::concurrency::WaitingTaskPtr,
+                                GlobalTaskGroup&) const;
+
+    cet::exempt_ptr<Principal const> principal_{nullptr};
   };
 
 } // namespace art
@@ -73,6 +73,12 @@ namespace art {
     return eventPrincipal_.processHistory();
   }
 
+  std::pmr::memory_resource*
+  Event::memoryResource() const
+  {
+    return eventPrincipal_.memoryResource();
+  }
+
   SubRun const&
   Event::getSubRun() const
   {
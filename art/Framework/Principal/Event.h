@@ -19,6 +19,7 @@
 #include "canvas/Persistency/Provenance/EventID.h"
 
 #include <memory>
+#include <memory_resource>
 #include <optional>
 
 namespace art {
@@ -53,6 +54,12 @@ namespace art {
     ProcessHistory const& processHistory() const;
     ProcessHistoryID const& processHistoryID() const;
 
+    // Memory that lives as long as the event.  Products (and their
+    // contents) allocated from it are released all at once, when the
+    // event is done; a product allocated from it must not be kept
+    // beyond the event.
+    std::pmr::memory_resource* memoryResource() const;
+
     using ProductRetriever::getHandle;
     using ProductRetriever::getInputTags;
     using ProductRetriever::getMany;
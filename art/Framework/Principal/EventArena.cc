@@ -0,0 +1,92 @@
+#include "art/Framework/Principal/EventArena.h"
+// vim: set sw=2 expandtab :
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace art {
+
+  EventArena::EventArena(size_t const chunkSize) : chunkSize_{chunkSize} {}
+
+  void
+  EventArena::reset()
+  {
+    lock_guard sentry{mutex_};
+    current_ = 0ull;
+    offset_ = 0ull;
+    bytesAllocated_ = 0ull;
+  }
+
+  size_t
+  EventArena::bytesAllocated() const
+  {
+    lock_guard sentry{mutex_};
+    return bytesAllocated_;
+  }
+
+  size_t
+  EventArena::highWaterMark() const
+  {
+    lock_guard sentry{mutex_};
+    return highWaterMark_;
+  }
+
+  size_t
+  EventArena::capacity() const
+  {
+    lock_guard sentry{mutex_};
+    return accumulate(cbegin(chunks_),
+                      cend(chunks_),
+                      size_t{},
+                      [](size_t const sum, Chunk const& chunk) {
+                        return sum + chunk.size;
+                      });
+  }
+
+  void*
+  EventArena::do_allocate(size_t const bytes, size_t const alignment)
+  {
+    lock_guard sentry{mutex_};
+    // Try the chunk being filled, then each of the chunks kept from
+    // earlier events.
+    for (; current_ < chunks_.size(); ++current_, offset_ = 0ull) {
+      auto& chunk = chunks_[current_];
+      void* p = chunk.data.get() + offset_;
+      auto space = chunk.size - offset_;
+      if (align(alignment, bytes, p, space)) {
+        offset_ = chunk.size - space + bytes;
+        bytesAllocated_ += bytes;
+        highWaterMark_ = max(highWaterMark_, bytesAllocated_);
+        return p;
+      }
+    }
+    // A new chunk is large enough for the request even in the worst
+    // case of alignment.
+    auto const size = max(chunkSize_, bytes + alignment);
+    // The memory is deliberately left uninitialized.
+    auto& chunk =
+      chunks_.emplace_back(Chunk{unique_ptr<byte[]>(new byte[size]), size});
+    void* p = chunk.data.get();
+    auto space = chunk.size;
+    align(alignment, bytes, p, space);
+    offset_ = chunk.size - space + bytes;
+    bytesAllocated_ += bytes;
+    highWaterMark_ = max(highWaterMark_, bytesAllocated_);
+    return p;
+  }
+
+  void
+  EventArena::do_deallocate(void*, size_t, size_t)
+  {
+    // The memory is reclaimed when the arena is reset.
+  }
+
+  bool
+  EventArena::do_is_equal(pmr::memory_resource const& other) const noexcept
+  {
+    return this == &other;
+  }
+
+} // namespace art
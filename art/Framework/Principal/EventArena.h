@@ -0,0 +1,75 @@
+#ifndef art_Framework_Principal_EventArena_h
+#define art_Framework_Principal_EventArena_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// EventArena
+//
+// A memory resource from which the products of one event may be
+// allocated (see Event::memoryResource).  Memory is handed out from
+// large chunks and is never returned piecemeal: deallocation is a
+// no-op, and all of the memory becomes available again at once when
+// the arena is reset.  The chunks are kept across resets, so an arena
+// that is reused for later events (see EventArenaPool) no longer
+// allocates once it has grown to the size of a typical event.
+//
+// Every object allocated from the arena must have been destroyed
+// before the arena is reset.  The products of an event satisfy this,
+// as they are destroyed along with the event principal.
+// ====================================================================
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace art {
+
+  class EventArena : public std::pmr::memory_resource {
+  public:
+    static constexpr std::size_t default_chunk_size{1ull << 20};
+
+    explicit EventArena(std::size_t chunkSize = default_chunk_size);
+
+    void reset();
+
+    // The number of bytes handed out since the last reset, and the
+    // largest such number seen over the lifetime of the arena.
+    std::size_t bytesAllocated() const;
+    std::size_t highWaterMark() const;
+    // The number of bytes held by the arena.
+    std::size_t capacity() const;
+
+  private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p,
+                       std::size_t bytes,
+                       std::size_t alignment) override;
+    bool do_is_equal(
+      std::pmr::memory_resource const& other) const noexcept override;
+
+    struct Chunk {
+      std::unique_ptr<std::byte[]> data;
+      std::size_t size;
+    };
+
+    std::size_t const chunkSize_;
+    // Protects access to all of the following.  Modules running
+    // concurrently for the same event may allocate at the same time.
+    mutable std::mutex mutex_{};
+    std::vector<Chunk> chunks_{};
+    // The chunk being filled, and the first free byte in it.
+    std::size_t current_{};
+    std::size_t offset_{};
+    std::size_t bytesAllocated_{};
+    std::size_t highWaterMark_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_EventArena_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -0,0 +1,64 @@
+#include "art/Framework/Principal/EventArenaPool.h"
+// vim: set sw=2 expandtab :
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+namespace art {
+
+  EventArenaPool*
+  EventArenaPool::instance()
+  {
+    static EventArenaPool me;
+    return &me;
+  }
+
+  void
+  EventArenaPool::setCapacity(size_t const capacity)
+  {
+    lock_guard sentry{mutex_};
+    capacity_ = capacity;
+    if (arenas_.size() > capacity_) {
+      arenas_.resize(capacity_);
+    }
+  }
+
+  unique_ptr<EventArena>
+  EventArenaPool::take()
+  {
+    lock_guard sentry{mutex_};
+    if (arenas_.empty()) {
+      ++statistics_.created;
+      return make_unique<EventArena>();
+    }
+    ++statistics_.reused;
+    auto result = std::move(arenas_.back());
+    arenas_.pop_back();
+    return result;
+  }
+
+  void
+  EventArenaPool::give(unique_ptr<EventArena> arena)
+  {
+    auto const highWaterMark = arena->highWaterMark();
+    auto const capacity = arena->capacity();
+    arena->reset();
+    lock_guard sentry{mutex_};
+    statistics_.highWaterMark = max(statistics_.highWaterMark, highWaterMark);
+    statistics_.largestCapacity = max(statistics_.largestCapacity, capacity);
+    if (arenas_.size() < capacity_) {
+      arenas_.push_back(std::move(arena));
+    }
+    // Otherwise, the arena is destroyed on return.
+  }
+
+  EventArenaPool::Statistics
+  EventArenaPool::statistics() const
+  {
+    lock_guard sentry{mutex_};
+    return statistics_;
+  }
+
+} // namespace art
@@ -0,0 +1,71 @@
+#ifndef art_Framework_Principal_EventArenaPool_h
+#define art_Framework_Principal_EventArenaPool_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// EventArenaPool
+//
+// Keeps the arenas of event principals that have been released so
+// that the principals of later events can reuse them (see
+// EventArena).  An event principal takes an arena only once the
+// memory resource of its event is first asked for.
+//
+// The pool is disabled until a capacity is set; an arena given to a
+// disabled or full pool is destroyed.  The EventProcessor allows one
+// arena per schedule and per read-ahead event.
+//
+// The pool also keeps statistics on the arenas, which are reported
+// in the end-of-job summary.
+// ====================================================================
+
+#include "art/Framework/Principal/EventArena.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace art {
+
+  class EventArenaPool {
+  public:
+    EventArenaPool(EventArenaPool const&) = delete;
+    EventArenaPool& operator=(EventArenaPool const&) = delete;
+
+    static EventArenaPool* instance();
+
+    void setCapacity(std::size_t);
+
+    std::unique_ptr<EventArena> take();
+    // Every object allocated from the arena must have been destroyed.
+    void give(std::unique_ptr<EventArena>);
+
+    struct Statistics {
+      // The number of arenas made, and the number of times an arena
+      // was reused.
+      std::size_t created{};
+      std::size_t reused{};
+      // The largest number of bytes allocated from an arena for one
+      // event, and the largest memory held by one arena.
+      std::size_t highWaterMark{};
+      std::size_t largestCapacity{};
+    };
+    Statistics statistics() const;
+
+  private:
+    EventArenaPool() = default;
+
+    // Protects access to all of the following.
+    mutable std::mutex mutex_{};
+    std::size_t capacity_{};
+    std::vector<std::unique_ptr<EventArena>> arenas_{};
+    Statistics statistics_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_EventArenaPool_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -1,11 +1,20 @@
 #include "art/Framework/Principal/EventPrincipal.h"
 #include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/EventArenaPool.h"
 
 // vim: set sw=2 expandtab :
 
 namespace art {
 
-  EventPrincipal::~EventPrincipal() = default;
+  EventPrincipal::~EventPrincipal()
+  {
+    // The products must be gone before the arena they may have been
+    // allocated from is reused.
+    giveGroupsToPool();
+    if (arena_) {
+      EventArenaPool::instance()->give(std::move(arena_));
+    }
+  }
 
   EventPrincipal::EventPrincipal(
     EventAuxiliary const& aux,
@@ -35,6 +44,41 @@ namespace art {
     return Event{*this, mc};
   }
 
+  std::pmr::memory_resource*
+  EventPrincipal::memoryResource() const
+  {
+    std::call_once(arenaTaken_,
+                   [this] { arena_ = EventArenaPool::instance()->take(); });
+    return arena_.get();
+  }
+
+  void
+  EventPrincipal::consumerDone(std::size_t const consumer) const
+  {
+    std::call_once(evictionPlanned_, [this] {
+      auto const table = presentProductTable();
+      if (table == nullptr) {
+        return;
+      }
+      evictionPlan_ = ProductEviction::instance()->plan(*table);
+      auto const& counts = evictionPlan_->consumerCounts;
+      remainingConsumers_ =
+        std::make_unique<std::atomic<unsigned>[]>(counts.size());
+      for (std::size_t i = 0; i != counts.size(); ++i) {
+        remainingConsumers_[i] = counts[i];
+      }
+    });
+    if (!evictionPlan_ || consumer >= evictionPlan_->consumed.size()) {
+      // The consumer was added after the plan was made.
+      return;
+    }
+    for (auto const i : evictionPlan_->consumed[consumer]) {
+      if (--remainingConsumers_[i] == 0u) {
+        evictProduct(evictionPlan_->products[i]);
+      }
+    }
+  }
+
   EventAuxiliary const&
   EventPrincipal::eventAux() const
   {
@@ -2,15 +2,21 @@
 #define art_Framework_Principal_EventPrincipal_h
 // vim: set sw=2 expandtab :
 
+#include "art/Framework/Principal/EventArena.h"
 #include "art/Framework/Principal/NoDelayedReader.h"
 #include "art/Framework/Principal/Principal.h"
+#include "art/Framework/Principal/ProductEviction.h"
 #include "canvas/Persistency/Provenance/BranchType.h"
 #include "canvas/Persistency/Provenance/EventAuxiliary.h"
 #include "canvas/Persistency/Provenance/ProductTables.h"
 #include "canvas/Persistency/Provenance/fwd.h"
 #include "cetlib/exempt_ptr.h"
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 
 namespace art {
 
@@ -47,10 +53,27 @@ namespace art {
     void createGroupsForProducedProducts(ProductTables const& producedProducts);
     void refreshProcessHistoryID();
 
+    // Used by Event.  The arena is taken from the EventArenaPool when
+    // first asked for, and given back once the products of the event
+    // have been destroyed.
+    std::pmr::memory_resource* memoryResource() const;
+
+    // Used by Worker when early product eviction is enabled: the
+    // products whose consumers have now all finished with this event
+    // are evicted (see ProductEviction).
+    void consumerDone(std::size_t consumer) const;
+
   private:
     cet::exempt_ptr<SubRunPrincipal const> subRunPrincipal_{nullptr};
     EventAuxiliary aux_;
     bool lastInSubRun_;
+    mutable std::once_flag arenaTaken_{};
+    mutable std::unique_ptr<EventArena> arena_{};
+    mutable std::once_flag evictionPlanned_{};
+    mutable std::shared_ptr<ProductEviction::Plan const> evictionPlan_{};
+    // The number of consumers of each product in the plan that have
+    // not yet finished.
+    mutable std::unique_ptr<std::atomic<unsigned>[]> remainingConsumers_{};
   };
 
 } // namespace art
@@ -2,6 +2,8 @@
 // vim: set sw=2 expandtab :
 
 #include "art/Framework/Principal/DelayedReader.h"
+#include "art/Framework/Principal/Principal.h"
+#include "art/Framework/Principal/RangeSetsSupported.h"
 #include "canvas/Persistency/Common/WrappedTypeID.h"
 #include "canvas/Persistency/Provenance/BranchDescription.h"
 #include "canvas/Persistency/Provenance/BranchType.h"
@@ -25,6 +27,7 @@ namespace art {
     delete partnerProduct_.load();
     delete baseProduct_.load();
     delete partnerBaseProduct_.load();
+    delete productView_.load();
   }
 
   Group::Group(DelayedReader* reader,
@@ -42,6 +45,9 @@ namespace art {
   EDProduct const*
   Group::getIt_() const
   {
+    if (grpType_ == grouptype::normal && resolved()) {
+      return product_.load();
+    }
     std::lock_guard sentry{mutex_};
     if (grpType_ == grouptype::normal) {
       resolveProductIfAvailable();
@@ -53,6 +59,9 @@ namespace art {
   EDProduct const*
   Group::anyProduct() const
   {
+    if (grpType_ == grouptype::normal && resolved()) {
+      return product_.load();
+    }
     std::lock_guard sentry{mutex_};
     if (grpType_ == grouptype::normal) {
       return product_.load();
@@ -77,6 +86,9 @@ namespace art {
   EDProduct const*
   Group::uniqueProduct() const
   {
+    if (grpType_ == grouptype::normal && resolved()) {
+      return product_.load();
+    }
     std::lock_guard sentry{mutex_};
     if (grpType_ == grouptype::normal) {
       return product_.load();
@@ -90,6 +102,9 @@ namespace art {
   EDProduct const*
   Group::uniqueProduct(TypeID const& wanted_wrapper_type) const
   {
+    if (auto product = resolvedProduct(wanted_wrapper_type)) {
+      return product;
+    }
     std::lock_guard sentry{mutex_};
     if (product_.load() == nullptr) {
       return nullptr;
@@ -137,6 +152,9 @@ namespace art {
   RangeSet const&
   Group::rangeOfValidity() const
   {
+    if (resolved()) {
+      return *rangeSet_.load();
+    }
     std::lock_guard sentry{mutex_};
     return *rangeSet_.load();
   }
@@ -144,8 +162,28 @@ namespace art {
   cet::exempt_ptr<ProductProvenance const>
   Group::productProvenance() const
   {
-    std::lock_guard sentry{mutex_};
-    return productProvenance_.load();
+    ProductProvenance const* pp{nullptr};
+    if (resolved()) {
+      pp = productProvenance_.load();
+    } else {
+      std::lock_guard sentry{mutex_};
+      pp = productProvenance_.load();
+    }
+    if (pp == nullptr && readFromEventInput()) {
+      return delayedReader_->principal()->provenanceOnFile(productID());
+    }
+    return pp;
+  }
+
+  // The provenance of an event product read from the input is kept by
+  // the principal rather than by the group (see
+  // Principal::provenanceOnFile).
+  bool
+  Group::readFromEventInput() const
+  {
+    return branchDescription_.branchType() == InEvent &&
+           !branchDescription_.produced() &&
+           delayedReader_->principal() != nullptr;
   }
 
   // Called by Principal::ctor_read_provenance()
@@ -155,6 +193,7 @@ namespace art {
   Group::setProductProvenance(unique_ptr<ProductProvenance const>&& pp)
   {
     std::lock_guard sentry{mutex_};
+    resolved_ = false;
     delete productProvenance_.load();
     productProvenance_ = pp.release();
   }
@@ -166,14 +205,41 @@ namespace art {
                                  unique_ptr<RangeSet>&& rs)
   {
     std::lock_guard sentry{mutex_};
+    resolved_ = false;
     delete productProvenance_.load();
     productProvenance_ = pp.release();
+    delete productView_.exchange(nullptr);
     delete product_.load();
     product_ = edp.release();
     delete rangeSet_.load();
     rangeSet_ = rs.release();
   }
 
+  void
+  Group::reset()
+  {
+    std::lock_guard sentry{mutex_};
+    resolved_ = false;
+    delete productProvenance_.exchange(nullptr);
+    delete productView_.exchange(nullptr);
+    delete product_.exchange(nullptr);
+    delete partnerProduct_.exchange(nullptr);
+    delete baseProduct_.exchange(nullptr);
+    delete partnerBaseProduct_.exchange(nullptr);
+    // The range set is kept, avoiding an allocation when reused.
+    if (auto rs = rangeSet_.load()) {
+      *rs = RangeSet::invalid();
+    } else {
+      rangeSet_ = new RangeSet{RangeSet::invalid()};
+    }
+  }
+
+  void
+  Group::setDelayedReader(DelayedReader* reader)
+  {
+    delayedReader_ = reader;
+  }
+
   void
   Group::removeCachedProduct()
   {
@@ -184,6 +250,8 @@ namespace art {
         << "This routine should only be used to remove large data products "
         << "read from disk (like raw digits).\n";
     }
+    resolved_ = false;
+    delete productView_.exchange(nullptr);
     delete product_.load();
     product_ = nullptr;
     if (grpType_ == grouptype::normal) {
@@ -202,15 +270,104 @@ namespace art {
     rangeSet_ = new RangeSet{RangeSet::invalid()};
   }
 
+  vector<void const*> const&
+  Group::productView(vector<void const*>& scratch) const
+  {
+    if (auto view = productView_.load(); view != nullptr) {
+      return *view;
+    }
+    auto const product = uniqueProduct();
+    if (!resolved()) {
+      // The product may still be replaced.
+      scratch = product->getView();
+      return scratch;
+    }
+    auto view = make_unique<vector<void const*>>(product->getView());
+    vector<void const*>* expected{nullptr};
+    if (productView_.compare_exchange_strong(expected, view.get())) {
+      return *view.release();
+    }
+    // Another module made the view first.
+    return *expected;
+  }
+
+  bool
+  Group::resolved() const
+  {
+    return resolved_.load(std::memory_order_acquire);
+  }
+
+  // Returns the product of the wanted wrapper type without taking the
+  // lock, or null if the group is not resolved or the product has not
+  // been made yet.
+  EDProduct const*
+  Group::resolvedProduct(TypeID const& wanted_wrapper_type) const
+  {
+    if (!resolved()) {
+      return nullptr;
+    }
+    if (grpType_ == grouptype::normal ||
+        wanted_wrapper_type == productType_) {
+      return product_.load(std::memory_order_acquire);
+    }
+    if (wanted_wrapper_type == partnerType_) {
+      return partnerProduct_.load(std::memory_order_acquire);
+    }
+    if (grpType_ == grouptype::assns) {
+      return nullptr;
+    }
+    if (wanted_wrapper_type == baseType_) {
+      return baseProduct_.load(std::memory_order_acquire);
+    }
+    if (wanted_wrapper_type == partnerBaseType_) {
+      return partnerBaseProduct_.load(std::memory_order_acquire);
+    }
+    return nullptr;
+  }
+
+  // Called with the lock held.
+  void
+  Group::markResolvedIfFinal() const
+  {
+    // Run and subrun products may still be replaced or combined with
+    // other fragments, so they are never considered final.
+    if (resolved() || range_sets_supported(branchDescription_.branchType())) {
+      return;
+    }
+    if (product_.load() == nullptr || !productAvailable()) {
+      return;
+    }
+    if (grpType_ == grouptype::assns) {
+      auto const assns_type_ids = product_.load()->getTypeIDs();
+      productType_ = assns_type_ids.at(product_metatype::LeftRight);
+      partnerType_ = assns_type_ids.at(product_metatype::RightLeft);
+    } else if (grpType_ == grouptype::assnsWithData) {
+      auto const assns_type_ids = product_.load()->getTypeIDs();
+      productType_ = assns_type_ids.at(product_metatype::LeftRightData);
+      partnerType_ = assns_type_ids.at(product_metatype::RightLeftData);
+      baseType_ = assns_type_ids.at(product_metatype::LeftRight);
+      partnerBaseType_ = assns_type_ids.at(product_metatype::RightLeft);
+    }
+    resolved_.store(true, std::memory_order_release);
+  }
+
   bool
   Group::productAvailable() const
   {
+    if (resolved()) {
+      return true;
+    }
     if (branchDescription_.dropped()) {
       // Not a product we are producing this time around, and it is not
       // present in any of the input files we have opened so far.
       return false;
     }
     assert(branchDescription_.present() || branchDescription_.produced());
+    if (readFromEventInput() && productProvenance_.load() == nullptr) {
+      // Answered from the status bitmap of the principal, without
+      // taking the lock.
+      return delayedReader_->principal()->availableOnFile(productID());
+    }
     std::lock_guard sentry{mutex_};
     bool availableAfterCombine{false};
     if ((branchDescription_.branchType() == InSubRun) ||
@@ -286,6 +443,10 @@ namespace art {
   Group::resolveProductIfAvailable(
     TypeID wanted_wrapper_type /*= TypeID{}*/) const
   {
+    if (resolved() && (!wanted_wrapper_type ||
+                       resolvedProduct(wanted_wrapper_type) != nullptr)) {
+      return true;
+    }
     std::lock_guard sentry{mutex_};
     // Now try to get the master product.
     if (product_.load() == nullptr) {
@@ -311,6 +472,7 @@ namespace art {
         return false;
       }
     }
+    markResolvedIfFinal();
 
     if (!wanted_wrapper_type) {
       // The type of the product is not known, therefore the on-disk
@@ -345,9 +507,10 @@ namespace art {
       }
       // They want the partner product, ask the wrapper to make it for us,
       // who ends up asking the assns to do it.
-      partnerProduct_ =
+      auto partner =
         product_.load()->makePartner(wanted_wrapper_type.typeInfo()).release();
-      return partnerProduct_.load() != nullptr;
+      partnerProduct_.store(partner, std::memory_order_release);
+      return partner != nullptr;
     }
 
     assert(grpType_ == grouptype::assnsWithData);
@@ -359,23 +522,31 @@ namespace art {
       }
       // They want the base, ask the wrapper to make it for us,
       // who ends up asking the assns to do it.
-      baseProduct_ =
+      auto base =
         product_.load()->makePartner(wanted_wrapper_type.typeInfo()).release();
-      return baseProduct_.load() != nullptr;
+      baseProduct_.store(base, std::memory_order_release);
+      return base != nullptr;
     }
     if (partnerBaseProduct_.load() != nullptr) {
       // They wanted the partner base product, and we have already made it,
       // done.
       return true;
     }
-    partnerBaseProduct_ =
+    auto partner_base =
       product_.load()->makePartner(wanted_wrapper_type.typeInfo()).release();
-    return partnerBaseProduct_.load() != nullptr;
+    partnerBaseProduct_.store(partner_base, std::memory_order_release);
+    return partner_base != nullptr;
   }
 
   bool
   Group::tryToResolveProduct(TypeID const& wanted_wrapper)
   {
+    // A resolved product is available, and Assns groups, which are
+    // the ones asked for partners, get them without the lock once
+    // they have been made.
+    if (resolvedProduct(wanted_wrapper) != nullptr) {
+      return true;
+    }
     std::lock_guard sentry{mutex_};
     resolveProductIfAvailable(wanted_wrapper);
 
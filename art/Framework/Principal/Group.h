@@ -23,6 +23,7 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace art {
@@ -47,6 +48,13 @@ namespace art {
     bool resolveProductIfAvailable(TypeID wanted_wrapper = TypeID{}) const;
     bool tryToResolveProduct(TypeID const&);
 
+    // Used by ProductRetriever::getView.  The addresses of the
+    // elements of the (container) product, as given by
+    // EDProduct::getView.  They are computed only once for a product
+    // that can no longer change, and into scratch otherwise.
+    std::vector<void const*> const& productView(
+      std::vector<void const*>& scratch) const;
+
     // Allows user module to remove a large fetched data product
     // after copying it.
     void removeCachedProduct();
@@ -70,12 +78,25 @@ namespace art {
                                  std::unique_ptr<EDProduct>&&,
                                  std::unique_ptr<RangeSet>&&);
 
+    // Called by GroupPool::give
+    //   Drops the product and its provenance so that the group can be
+    //   reused for another principal.
+    void reset();
+    // Called by Principal::fillGroup when reusing the group.
+    void setDelayedReader(DelayedReader*);
+
   private:
+    bool resolved() const;
+    EDProduct const* resolvedProduct(TypeID const&) const;
+    bool readFromEventInput() const;
+    void markResolvedIfFinal() const;
+
     BranchDescription const& branchDescription_;
 
     // Back pointer to the delayed reader in the principal that owns
     // us.
-    cet::exempt_ptr<DelayedReader const> const delayedReader_;
+    // Note: Modified by setDelayedReader when the group is reused.
+    cet::exempt_ptr<DelayedReader const> delayedReader_;
     // Used to serialize access to productProvenance_, product_,
     // rangeSet_, partnerProduct_, baseProduct_, and
     // partnerBaseProduct_.  This is recursive because sometimes we
@@ -85,9 +106,28 @@ namespace art {
     // this locked to make the updating of provenance and product
     // pointers together one atomic transaction.
     mutable std::recursive_mutex mutex_{};
+    // Set once the product has been obtained and is known to be
+    // available, after which it cannot change until the group is
+    // reset or the product is removed.  Reading a resolved product,
+    // its provenance, and its range set then takes no lock.  Assns
+    // partners are made under the lock, once each, and are published
+    // with a release store so that, once made, they too are read
+    // without the lock (see resolvedProduct).
+    // Note: Never set for run and subrun products, which may be
+    // replaced.
+    mutable std::atomic<bool> resolved_{false};
+    // The wrapper types of the products an Assns group can hand out.
+    // Note: Set by markResolvedIfFinal just before resolved_, and only
+    // read once resolved_ is seen set.
+    mutable TypeID productType_{};
+    mutable TypeID partnerType_{};
+    mutable TypeID baseType_{};
+    mutable TypeID partnerBaseType_{};
     // The product provenance for the data product.
     // Note: Modified by setProductProvenance (called by Principal ctors and
     // Principal::insert_pp (called by Principal::put).
+    // Note: Null for event products read from the input, whose
+    // provenance is kept by the principal.
     std::atomic<ProductProvenance const*> productProvenance_{nullptr};
     // The wrapped data product itself.
     // Note: Modified by setProduct (called by Principal::put)
@@ -118,8 +158,18 @@ namespace art {
     // Note: Modified by removeCachedProduct.
     // Note: Modified by resolveProductIfAvailable.
     mutable std::atomic<EDProduct*> partnerBaseProduct_{nullptr};
+    // The element addresses of the product once it is final, shared
+    // by all getView calls for it.
+    // Note: Modified by productView.
+    // Note: Cleared by setProductAndProvenance, removeCachedProduct,
+    // and reset.
+    mutable std::atomic<std::vector<void const*>*> productView_{nullptr};
   };
 
+  // The groups of a principal, along with their ProductIDs.
+  using GroupCollection =
+    std::vector<std::pair<ProductID, std::unique_ptr<Group>>>;
+
   std::optional<GroupQueryResult> resolve_unique_product(
     std::vector<cet::exempt_ptr<art::Group>> const& groups,
     art::WrappedTypeID const& wrapped);
@@ -0,0 +1,83 @@
+#include "art/Framework/Principal/GroupPool.h"
+// vim: set sw=2 expandtab :
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+namespace art {
+
+  GroupPool*
+  GroupPool::instance()
+  {
+    static GroupPool me;
+    return &me;
+  }
+
+  void
+  GroupPool::setCapacity(size_t const capacity)
+  {
+    lock_guard sentry{mutex_};
+    capacity_ = capacity;
+    if (sets_.size() > capacity_) {
+      sets_.resize(capacity_);
+    }
+  }
+
+  GroupCollection
+  GroupPool::take(ProductTable const* table)
+  {
+    GroupCollection result;
+    lock_guard sentry{mutex_};
+    // The most recently given set is the most likely to match.
+    auto it = find_if(sets_.rbegin(), sets_.rend(), [table](auto const& set) {
+      return set.first == table;
+    });
+    if (it != sets_.rend()) {
+      result = std::move(it->second);
+      sets_.erase(next(it).base());
+    }
+    return result;
+  }
+
+  void
+  GroupPool::give(ProductTable const* table, GroupCollection&& groups)
+  {
+    if (groups.empty()) {
+      return;
+    }
+    {
+      lock_guard sentry{mutex_};
+      if (capacity_ == 0ull) {
+        // The groups are left to be destroyed by the caller.
+        return;
+      }
+    }
+    // The products are dropped before taking the lock again, as this
+    // can be expensive.
+    for (auto const& [pid, group] : groups) {
+      group->reset();
+    }
+    // If the pool is full, the oldest set is evicted; it is destroyed
+    // after the lock has been released.
+    GroupCollection evicted;
+    lock_guard sentry{mutex_};
+    if (capacity_ == 0ull) {
+      return;
+    }
+    if (sets_.size() == capacity_) {
+      evicted = std::move(sets_.front().second);
+      sets_.erase(sets_.begin());
+    }
+    sets_.emplace_back(table, std::move(groups));
+  }
+
+  void
+  GroupPool::clear()
+  {
+    lock_guard sentry{mutex_};
+    sets_.clear();
+  }
+
+} // namespace art
@@ -0,0 +1,62 @@
+#ifndef art_Framework_Principal_GroupPool_h
+#define art_Framework_Principal_GroupPool_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// GroupPool
+//
+// Keeps the groups of event principals that have been released so
+// that the principals of later events can reuse them, rather than
+// allocate one group (and range set) per product for each event.
+//
+// The groups of a principal are given back as one set, tagged with
+// the product table of the principal; a new principal only takes a
+// set that was made for its own product table.  A group is reused
+// only for the very product description it was made for (see
+// Principal::fillGroup), so a set that no longer matches the tables
+// is simply discarded.
+//
+// The pool is disabled until a capacity is set.  The EventProcessor
+// allows one set per schedule and per read-ahead event.
+// ====================================================================
+
+#include "art/Framework/Principal/Group.h"
+#include "canvas/Persistency/Provenance/fwd.h"
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace art {
+
+  class GroupPool {
+  public:
+    GroupPool(GroupPool const&) = delete;
+    GroupPool& operator=(GroupPool const&) = delete;
+
+    static GroupPool* instance();
+
+    void setCapacity(std::size_t);
+
+    // Returns an empty collection if there is no set for the table.
+    GroupCollection take(ProductTable const*);
+    void give(ProductTable const*, GroupCollection&&);
+    void clear();
+
+  private:
+    GroupPool() = default;
+
+    // Protects access to capacity_ and sets_.
+    std::mutex mutex_{};
+    std::size_t capacity_{};
+    std::vector<std::pair<ProductTable const*, GroupCollection>> sets_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_GroupPool_h */
+
+// Local Variables:
+// mode: c++
+// End:
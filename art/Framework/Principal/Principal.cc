@@ -3,14 +3,22 @@
 
 #include "art/Framework/Principal/DelayedReader.h"
 #include "art/Framework/Principal/Group.h"
+#include "art/Framework/Principal/GroupPool.h"
 #include "art/Framework/Principal/OutputHandle.h"
 #include "art/Framework/Principal/ProcessTag.h"
+#include "art/Framework/Principal/ProductEviction.h"
+#include "art/Framework/Principal/ProductTableIndex.h"
+#include "art/Framework/Principal/ProductTokenCache.h"
 #include "art/Framework/Principal/RangeSetsSupported.h"
+#include "art/Framework/Principal/SecondaryFileIndex.h"
 #include "art/Framework/Principal/Selector.h"
+#include "art/Framework/Principal/SelectorMatchCache.h"
+#include "art/Framework/Principal/TypeLookupIndex.h"
 #include "art/Framework/Principal/fwd.h"
 #include "art/Persistency/Common/GroupQueryResult.h"
 #include "art/Persistency/Provenance/ModuleContext.h"
 #include "art/Persistency/Provenance/ProcessHistoryRegistry.h"
+#include "art/Utilities/GlobalTaskGroup.h"
 #include "canvas/Persistency/Common/WrappedTypeID.h"
 #include "canvas/Persistency/Provenance/BranchDescription.h"
 #include "canvas/Persistency/Provenance/BranchType.h"
@@ -28,14 +36,18 @@
 #include "cetlib/exempt_ptr.h"
 #include "range/v3/view.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 using namespace cet;
+using namespace hep::concurrency;
 using namespace std;
 
 namespace {
@@ -62,6 +74,19 @@ namespace art {
         reader, bd, make_unique<RangeSet>(RangeSet::invalid()), gt);
     }
 
+    // The key under which a secondary file holding the products that
+    // match a selector is indexed; selectors without a cache key are
+    // not indexed.
+    string
+    secondary_file_key(string const& lookup, SelectorBase const& sel)
+    {
+      auto const& sel_key = sel.cacheKey();
+      if (sel_key.empty()) {
+        return {};
+      }
+      return lookup + ';' + sel_key;
+    }
+
   } // unnamed namespace
 
   void
@@ -78,16 +103,30 @@ namespace art {
     //       code expects to be able to find a group for dropped
     //       products, so getGroupTryAllFiles ignores groups for
     //       dropped products instead.
+    presentPositions_ =
+      ProductTableIndex::instance()->positions(*presentProducts);
+    groups_.reserve(presentProducts->descriptions.size());
     for (auto const& pd :
          presentProducts->descriptions | ::ranges::views::values) {
       assert(pd.branchType() == branchType_);
       fillGroup(pd);
     }
+    producedGroupsBegin_ = groups_.size();
   }
 
   void
   Principal::ctor_read_provenance()
   {
+    if (branchType_ == InEvent) {
+      // Most modules never look at the provenance of event products,
+      // so, if the reader allows it, it is read only when first needed
+      // rather than while the input source lock is held.  Otherwise,
+      // it is read now, under that lock.
+      if (!delayedReader_->readsProvenanceConcurrently()) {
+        readProvenanceOnce();
+      }
+      return;
+    }
     for (auto&& provenance : delayedReader_->readProvenance()) {
       auto g = getGroupLocal(provenance.productID());
       if (g.get() == nullptr) {
@@ -105,6 +144,66 @@ namespace art {
     }
   }
 
+  void
+  Principal::readProvenanceOnce() const
+  {
+    // No group is locked here: a group may ask for its provenance
+    // while holding its own lock.  Unless the reader reads provenance
+    // concurrently with products, this is first called from the
+    // constructor (see ctor_read_provenance).
+    call_once(provenanceRead_, [this] {
+      availableOnFile_.assign(groups_.size(), false);
+      for (auto&& provenance : delayedReader_->readProvenance()) {
+        auto const index = groupIndex(provenance.productID());
+        if (!index) {
+          continue;
+        }
+        auto status = provenance.productStatus();
+        if (status == productstatus::unknown()) {
+          // We have an old format file, convert.
+          status = productstatus::dummyToPreventDoubleCount();
+          provenanceOnFile_.push_back(make_unique<ProductProvenance>(
+            provenance.productID(), status, provenance.parentage().parents()));
+        } else {
+          provenanceOnFile_.push_back(
+            make_unique<ProductProvenance>(provenance));
+        }
+        // The same rule as in Group::productAvailable.
+        availableOnFile_[*index] =
+          status == productstatus::present() ||
+          status == productstatus::dummyToPreventDoubleCount();
+      }
+      sort(provenanceOnFile_.begin(),
+           provenanceOnFile_.end(),
+           [](auto const& a, auto const& b) {
+             return a->productID() < b->productID();
+           });
+    });
+  }
+
+  cet::exempt_ptr<ProductProvenance const>
+  Principal::provenanceOnFile(ProductID const pid) const
+  {
+    readProvenanceOnce();
+    auto const by_pid = [](auto const& pp, ProductID const pid) {
+      return pp->productID() < pid;
+    };
+    auto it = lower_bound(
+      provenanceOnFile_.cbegin(), provenanceOnFile_.cend(), pid, by_pid);
+    if (it == provenanceOnFile_.cend() || (*it)->productID() != pid) {
+      return nullptr;
+    }
+    return it->get();
+  }
+
+  bool
+  Principal::availableOnFile(ProductID const pid) const
+  {
+    readProvenanceOnce();
+    auto const index = groupIndex(pid);
+    return index.has_value() && availableOnFile_[*index];
+  }
+
   void
   Principal::ctor_fetch_process_history(ProcessHistoryID const& phid)
   {
@@ -128,6 +227,9 @@ namespace art {
     , delayedReader_{std::move(reader)}
   {
     delayedReader_->setPrincipal(this);
+    if (branchType_ == InEvent) {
+      recycledGroups_ = GroupPool::instance()->take(presentProducts.get());
+    }
     ctor_create_groups(presentProducts);
     ctor_read_provenance();
     ctor_fetch_process_history(hist);
@@ -136,12 +238,10 @@ namespace art {
   void
   Principal::fillGroup(BranchDescription const& pd)
   {
-    std::lock_guard sentry{groupMutex_};
-    auto it = groups_.find(pd.productID());
-    if (it != std::cend(groups_)) {
+    if (auto const index = groupIndex(pd.productID())) {
       // The 'combinable' call does not require that the processing
       // history be the same, which is not what we are checking for here.
-      auto const& found_pd = it->second->productDescription();
+      auto const& found_pd = groups_[*index].second->productDescription();
       if (combinable(found_pd, pd)) {
         throw Exception(errors::Configuration)
           << "The process name " << pd.processName()
@@ -159,7 +259,62 @@ namespace art {
         << "In addition, please notify artists@fnal.gov of this error.\n";
     }
 
-    groups_[pd.productID()] = create_group(delayedReader_.get(), pd);
+    // The groups of each block must be filled in ProductID order.
+    assert(groups_.size() == producedGroupsBegin_ ||
+           groups_.back().first < pd.productID());
+    groups_.emplace_back(pd.productID(), recycledOrNewGroup(pd));
+  }
+
+  unique_ptr<Group>
+  Principal::recycledOrNewGroup(BranchDescription const& pd)
+  {
+    if (nextRecycledGroup_ < recycledGroups_.size()) {
+      auto& [pid, group] = recycledGroups_[nextRecycledGroup_];
+      // A group refers to its product description, so it can only be
+      // reused for that same description.
+      if (pid == pd.productID() && &group->productDescription() == &pd) {
+        ++nextRecycledGroup_;
+        group->setDelayedReader(delayedReader_.get());
+        return std::move(group);
+      }
+      // The tables have changed; none of the remaining groups will
+      // match.
+      recycledGroups_.clear();
+    }
+    return create_group(delayedReader_.get(), pd);
+  }
+
+  void
+  Principal::giveGroupsToPool()
+  {
+    GroupPool::instance()->give(presentProducts_.load(), std::move(groups_));
+    // Any groups the pool did not keep, and their products, are
+    // destroyed now.
+    groups_.clear();
+  }
+
+  ProductTable const*
+  Principal::producedProductTable() const
+  {
+    return producedProducts_.load();
+  }
+
+  ProductTable const*
+  Principal::presentProductTable() const
+  {
+    return presentProducts_.load();
+  }
+
+  void
+  Principal::evictProduct(ProductID const pid) const
+  {
+    auto group = getGroupLocal(pid);
+    if (!group || group->anyProduct() == nullptr) {
+      // Never read, nothing to evict.
+      return;
+    }
+    group->removeCachedProduct();
+    ProductEviction::instance()->countEviction();
   }
 
   // FIXME: This breaks the purpose of the
@@ -203,23 +358,29 @@ namespace art {
   {
     auto const& produced = producedProducts.get(branchType_);
     producedProducts_ = &produced;
-    if (produced.descriptions.empty()) {
-      return;
-    }
-    // The process history is expanded if there is a product that is
-    // produced in this process.
-    addToProcessHistory();
-    for (auto const& pd : produced.descriptions | ::ranges::views::values) {
-      assert(pd.branchType() == branchType_);
-      // Create a group for the produced product.
-      fillGroup(pd);
+    resetTokenResolutions();
+    producedGroupsBegin_ = groups_.size();
+    producedPositions_ = ProductTableIndex::instance()->positions(produced);
+    if (!produced.descriptions.empty()) {
+      // The process history is expanded if there is a product that is
+      // produced in this process.
+      addToProcessHistory();
+      groups_.reserve(groups_.size() + produced.descriptions.size());
+      for (auto const& pd : produced.descriptions | ::ranges::views::values) {
+        assert(pd.branchType() == branchType_);
+        // Create a group for the produced product.
+        fillGroup(pd);
+      }
     }
+    // Any groups that have not been reused are no longer needed.
+    recycledGroups_ = GroupCollection{};
   }
 
   void
   Principal::enableLookupOfProducedProducts()
   {
     enableLookupOfProducedProducts_ = true;
+    resetTokenResolutions();
   }
 
   void
@@ -237,12 +398,33 @@ namespace art {
     //          because the delay read fills the pp_by_pid_ one entry
     //          at a time, and we do not want other threads to find
     //          the info only partly there.
-    std::lock_guard sentry{groupMutex_};
     for (auto const& group : groups_ | ::ranges::views::values) {
       group->resolveProductIfAvailable();
     }
   }
 
+  void
+  Principal::prefetchAsync(
+    ModuleContext const& mc,
+    std::vector<ProductTokenCache::Consumed> const& consumed,
+    WaitingTaskPtr doneTask,
+    GlobalTaskGroup& taskGroup) const
+  {
+    // Only the products of the input file are prefetched--those
+    // produced in this process are not read, and opening a secondary
+    // file is left to the module's own retrieval.
+    std::vector<cet::exempt_ptr<Group const>> groups;
+    for (auto const& [index, info] : consumed) {
+      for (auto const& [gindex, pid] : tokenCandidates(mc, index, info)) {
+        if (gindex < producedGroupsBegin_ && groups_[gindex].first == pid) {
+          groups.emplace_back(groups_[gindex].second.get());
+        }
+      }
+    }
+    delayedReader_->prefetchAsync(
+      std::move(groups), std::move(doneTask), taskGroup);
+  }
+
   ProcessHistory const&
   Principal::processHistory() const
   {
@@ -262,35 +444,30 @@ namespace art {
   size_t
   Principal::size() const
   {
-    std::lock_guard sentry{groupMutex_};
     return groups_.size();
   }
 
   Principal::const_iterator
   Principal::begin() const
   {
-    std::lock_guard sentry{groupMutex_};
     return groups_.begin();
   }
 
   Principal::const_iterator
   Principal::cbegin() const
   {
-    std::lock_guard sentry{groupMutex_};
     return groups_.cbegin();
   }
 
   Principal::const_iterator
   Principal::end() const
   {
-    std::lock_guard sentry{groupMutex_};
     return groups_.end();
   }
 
   Principal::const_iterator
   Principal::cend() const
   {
-    std::lock_guard sentry{groupMutex_};
     return groups_.cend();
   }
 
@@ -313,22 +490,11 @@ namespace art {
     return ret;
   }
 
-  // Note: threading: The solution chosen for the following
-  // problems is to convert groups_ from type:
-  //
-  //   std::map<ProductID, std::unique_ptr<Group>>
-  //
-  // to type:
-  //
-  //   tbb::concurrent_unordered_map<
-  //     ProductID, std::unique_ptr<Group>>
-  //
-  // We get concurrent insertion and iteration, but not
-  // concurrent erasure (which is not a problem because we never
-  // remove groups).  Note that tbb uses a value for the end()
-  // iterator for this class which is always valid for comparing
-  // against the result of an interation or find (it is
-  // implemented as (<element-ptr>(nullptr), <internal-table>)).
+  // Note: threading: The problems described below are solved by
+  // creating all groups while the principal is being set up (see
+  // ctor_create_groups and createGroupsForProducedProducts).  The
+  // groups_ vector is never modified afterwards, so lookups and
+  // iteration need no lock.
   //
   // Note: threading: May be called from producer and filter
   // module processing tasks! This requires us to protect
@@ -454,6 +620,7 @@ namespace art {
       // one Event.
       auto const phid = processHistory_.id();
       ProcessHistoryRegistry::emplace(phid, processHistory_);
+      resetTokenResolutions();
     }
   }
 
@@ -472,13 +639,14 @@ namespace art {
     //          inserting a process history entry while we are
     //          iterating.
     std::lock_guard sentry{processHistory_.get_mutex()};
+    auto const& key = sel.cacheKey();
     // We must skip over duplicate entries of the same process
     // configuration in the process history.  This unfortunately
     // happened with the SamplingInput source.
     for (auto const& h :
          ::ranges::views::reverse(processHistory_) | ::ranges::views::unique) {
       if (auto it = pl.find(h.processName()); it != pl.end()) {
-        found += findGroupsForProcess(it->second, mc, sel, groups);
+        found += findGroupsForProcess(it->second, mc, sel, key, groups);
       }
     }
     return found;
@@ -516,6 +684,114 @@ namespace art {
     return getBySelector(mc, wrapped, sel, processTag);
   }
 
+  GroupQueryResult
+  Principal::getByToken(ModuleContext const& mc,
+                        WrappedTypeID const& wrapped,
+                        std::size_t const index,
+                        ProductInfo const& declared) const
+  {
+    auto const& candidates = tokenCandidates(mc, index, declared);
+    std::vector<cet::exempt_ptr<Group>> groups;
+    groups.reserve(candidates.size());
+    for (auto const& [gindex, pid] : candidates) {
+      // The ProductID guards against a product table whose storage
+      // has been reused for a different table.
+      if (gindex >= groups_.size() || !(groups_[gindex].first == pid)) {
+        continue;
+      }
+      cet::exempt_ptr<Group> group{groups_[gindex].second.get()};
+      // The same visibility rule as in findGroupsForProcess.
+      auto const& pd = group->productDescription();
+      if (mc.onTriggerPath() && pd.produced() &&
+          !mc.onSamePathAs(pd.moduleLabel())) {
+        continue;
+      }
+      groups.emplace_back(group);
+    }
+    if (!groups.empty()) {
+      if (auto const result = resolve_unique_product(groups, wrapped)) {
+        return *result;
+      }
+    }
+    // Either the product can only be found in a secondary input file,
+    // or it cannot be found at all; the full lookup takes care of
+    // both, including the explanation of the failure.
+    return getByLabel(
+      mc, wrapped, declared.label, declared.instance, declared.process);
+  }
+
+  ProductTokenCache::Candidates const&
+  Principal::tokenCandidates(ModuleContext const& mc,
+                             std::size_t const index,
+                             ProductInfo const& declared) const
+  {
+    auto& resolutions = tokenResolutions();
+    if (auto candidates = resolutions.find(index)) {
+      return *candidates;
+    }
+    // The candidates must not depend on the path of the module, so
+    // they are looked up without a path context.  Path visibility is
+    // applied to the candidates by getByToken.
+    ModuleContext const anyPath{mc.moduleDescription()};
+    Selector const sel{ModuleLabelSelector{declared.label} &&
+                       ProductInstanceNameSelector{declared.instance} &&
+                       ProcessNameSelector{declared.process.name()}};
+    std::vector<cet::exempt_ptr<Group>> groups;
+    if (declared.process.current_process_search_allowed() &&
+        enableLookupOfProducedProducts_.load()) {
+      if (auto pl = TypeLookupIndex::instance()->find(
+            *producedProducts_.load(), declared.typeID)) {
+        findGroups(*pl, anyPath, sel, groups);
+      }
+    }
+    if (declared.process.input_source_search_allowed() &&
+        presentProducts_.load()) {
+      if (auto pl = TypeLookupIndex::instance()->find(
+            *presentProducts_.load(), declared.typeID)) {
+        findGroups(*pl, anyPath, sel, groups);
+      }
+    }
+    ProductTokenCache::Candidates result;
+    result.reserve(groups.size());
+    for (auto const g : groups) {
+      auto const pid = g->productDescription().productID();
+      auto const gindex = groupIndex(pid);
+      assert(gindex.has_value());
+      result.push_back({*gindex, pid});
+    }
+    return resolutions.insert(index, std::move(result));
+  }
+
+  ProductTokenCache::Resolutions&
+  Principal::tokenResolutions() const
+  {
+    if (auto resolutions = tokenResolutions_.load()) {
+      return *resolutions;
+    }
+    std::lock_guard sentry{tokenResolutionsMutex_};
+    if (auto resolutions = tokenResolutions_.load()) {
+      return *resolutions;
+    }
+    ProductTokenCache::Tables const tables{
+      presentProducts_.load(),
+      enableLookupOfProducedProducts_.load() ? producedProducts_.load() :
+                                               nullptr,
+      processHistoryID()};
+    auto resolutions = ProductTokenCache::instance()->resolutions(tables);
+    tokenResolutions_ = resolutions.get();
+    usedTokenResolutions_.push_back(std::move(resolutions));
+    return *tokenResolutions_.load();
+  }
+
+  // Called whenever the product tables or the process history of the
+  // principal change.
+  void
+  Principal::resetTokenResolutions()
+  {
+    std::lock_guard sentry{tokenResolutionsMutex_};
+    tokenResolutions_ = nullptr;
+  }
+
   std::vector<InputTag>
   Principal::getInputTags(ModuleContext const& mc,
                           WrappedTypeID const& wrapped,
@@ -540,10 +816,61 @@ namespace art {
     return resolve_products(groups, wrapped.wrapped_product_type);
   }
 
-  auto
-  Principal::tryNextSecondaryFile() const
+  cet::exempt_ptr<Principal>
+  Principal::secondaryPrincipal(int const first, int& fileIndex) const
+  {
+    // A file may be reached both through the secondary-file index and
+    // in turn, but its principal is made only once.
+    if (auto it = secondaryFilesRead_.find(first);
+        it != secondaryFilesRead_.cend()) {
+      fileIndex = first;
+      return it->second;
+    }
+    fileIndex = first;
+    auto sp = delayedReader_->readFromSecondaryFile(fileIndex);
+    if (!sp) {
+      return nullptr;
+    }
+    // The reader leaves the index one past that of the file read.
+    --fileIndex;
+    auto [it, inserted] = secondaryFilesRead_.try_emplace(fileIndex, sp.get());
+    if (inserted) {
+      // Otherwise, the reader passed over the files before one that
+      // was already read, and the copy just read is discarded.
+      secondaryPrincipals_.push_back(std::move(sp));
+    }
+    return it->second;
+  }
+
+  cet::exempt_ptr<Principal>
+  Principal::tryNextSecondaryFile(int& fileIndex) const
+  {
+    auto result = secondaryPrincipal(nextSecondaryFileIdx_, fileIndex);
+    nextSecondaryFileIdx_ = result ? fileIndex + 1 : fileIndex;
+    return result;
+  }
+
+  cet::exempt_ptr<Principal>
+  Principal::indexedSecondaryFile(string const& key) const
+  {
+    if (key.empty()) {
+      return nullptr;
+    }
+    auto const fileIndex =
+      SecondaryFileIndex::instance()->find(branchType_, key);
+    if (!fileIndex) {
+      return nullptr;
+    }
+    int read{};
+    return secondaryPrincipal(*fileIndex, read);
+  }
+
+  void
+  Principal::indexSecondaryFile(string const& key, int const fileIndex) const
   {
-    return delayedReader_->readFromSecondaryFile(nextSecondaryFileIdx_);
+    if (!key.empty()) {
+      SecondaryFileIndex::instance()->insert(branchType_, key, fileIndex);
+    }
   }
 
   std::vector<cet::exempt_ptr<Group>>
@@ -578,15 +905,24 @@ namespace art {
         }
       }
     }
-    // Open more secondary files if necessary
+    // Open more secondary files if necessary, starting with the one
+    // in which matching products were previously found.
     if (groups.empty()) {
-      while (auto sp = tryNextSecondaryFile()) {
-        auto& new_sp = secondaryPrincipals_.emplace_back(std::move(sp));
-        groups = new_sp->matchingSequenceFromInputFile(mc, selector);
+      auto const key = secondary_file_key("view", selector);
+      if (auto sp = indexedSecondaryFile(key)) {
+        groups = sp->matchingSequenceFromInputFile(mc, selector);
         if (!groups.empty()) {
           return groups;
         }
       }
+      int fileIndex{};
+      while (auto sp = tryNextSecondaryFile(fileIndex)) {
+        groups = sp->matchingSequenceFromInputFile(mc, selector);
+        if (!groups.empty()) {
+          indexSecondaryFile(key, fileIndex);
+          return groups;
+        }
+      }
     }
     return groups;
   }
@@ -613,12 +949,12 @@ namespace art {
     if (!presentProducts_.load()) {
       return 0;
     }
-    auto const& lookup = presentProducts_.load()->productLookup;
-    auto it = lookup.find(wrapped.product_type.friendlyClassName());
-    if (it == lookup.end()) {
+    auto pl = TypeLookupIndex::instance()->find(*presentProducts_.load(),
+                                                wrapped.product_type);
+    if (pl == nullptr) {
       return 0;
     }
-    return findGroups(it->second, mc, selector, groups);
+    return findGroups(*pl, mc, selector, groups);
   }
 
   std::vector<cet::exempt_ptr<Group>>
@@ -632,10 +968,9 @@ namespace art {
     // Find groups from current process
     if (processTag.current_process_search_allowed() &&
         enableLookupOfProducedProducts_.load()) {
-      auto const& lookup = producedProducts_.load()->productLookup;
-      auto it = lookup.find(wrapped.product_type.friendlyClassName());
-      if (it != lookup.end()) {
-        ret += findGroups(it->second, mc, selector, results);
+      if (auto pl = TypeLookupIndex::instance()->find(
+            *producedProducts_.load(), wrapped.product_type)) {
+        ret += findGroups(*pl, mc, selector, results);
       }
     }
 
@@ -653,25 +988,68 @@ namespace art {
         return results;
       }
     }
-    // Open more secondary files if necessary
-    while (auto sp = tryNextSecondaryFile()) {
-      auto& new_sp = secondaryPrincipals_.emplace_back(std::move(sp));
-      if (new_sp->findGroupsFromInputFile(mc, wrapped, selector, results)) {
+    // Open more secondary files if necessary, starting with the one
+    // in which matching products were previously found.
+    auto const& typeName =
+      TypeLookupIndex::instance()->friendlyClassName(wrapped.product_type);
+    auto const key = secondary_file_key("product:" + typeName, selector);
+    if (auto sp = indexedSecondaryFile(key)) {
+      if (sp->findGroupsFromInputFile(mc, wrapped, selector, results)) {
+        return results;
+      }
+    }
+    int fileIndex{};
+    while (auto sp = tryNextSecondaryFile(fileIndex)) {
+      if (sp->findGroupsFromInputFile(mc, wrapped, selector, results)) {
+        indexSecondaryFile(key, fileIndex);
         return results;
       }
     }
     return results;
   }
 
+  std::shared_ptr<SelectorMatchCache::Matches const>
+  Principal::selectorMatches(std::vector<ProductID> const& vpid,
+                             SelectorBase const& sel,
+                             std::string const& key) const
+  {
+    if (key.empty()) {
+      return nullptr;
+    }
+    auto cache = SelectorMatchCache::instance();
+    if (auto matches = cache->find(vpid, key)) {
+      return matches;
+    }
+    SelectorMatchCache::Matches result;
+    for (auto const pid : vpid) {
+      auto group = getGroupLocal(pid);
+      if (!group) {
+        // Without its description, the product cannot be matched on
+        // behalf of other principals.
+        return nullptr;
+      }
+      if (sel.match(group->productDescription())) {
+        result.push_back(pid);
+      }
+    }
+    auto matches =
+      make_shared<SelectorMatchCache::Matches const>(std::move(result));
+    cache->insert(vpid, key, matches);
+    return matches;
+  }
+
   std::size_t
   Principal::findGroupsForProcess(
     std::vector<ProductID> const& vpid,
     ModuleContext const& mc,
     SelectorBase const& sel,
+    std::string const& key,
     std::vector<cet::exempt_ptr<Group>>& res) const
   {
     std::size_t found{}; // Horrible hack that should go away
-    for (auto const pid : vpid) {
+    // If known, only the products matched by the selector are visited.
+    auto const matches = selectorMatches(vpid, sel, key);
+    for (auto const pid : matches ? *matches : vpid) {
       auto group = getGroupLocal(pid);
       if (!group) {
         continue;
@@ -687,7 +1065,7 @@ namespace art {
           !mc.onSamePathAs(pd.moduleLabel())) {
         continue;
       }
-      if (!sel.match(pd)) {
+      if (!matches && !sel.match(pd)) {
         continue;
       }
       // Found a good match, save it.
@@ -851,9 +1229,35 @@ namespace art {
   cet::exempt_ptr<Group>
   Principal::getGroupLocal(ProductID const pid) const
   {
-    std::lock_guard sentry{groupMutex_};
-    auto it = groups_.find(pid);
-    return it != groups_.cend() ? it->second.get() : nullptr;
+    auto const index = groupIndex(pid);
+    return index ? groups_[*index].second.get() : nullptr;
+  }
+
+  std::optional<std::size_t>
+  Principal::groupIndex(ProductID const pid) const
+  {
+    // A group's position in its block is the position of its product
+    // in the product table.  While the groups are being filled, a
+    // block may not yet hold the group.
+    auto const in_block = [this, pid](auto const& positions,
+                                      std::size_t const begin,
+                                      std::size_t const end)
+      -> std::optional<std::size_t> {
+      if (!positions) {
+        return std::nullopt;
+      }
+      auto const pos = positions->find(pid);
+      if (!pos || begin + *pos >= end) {
+        return std::nullopt;
+      }
+      auto const index = begin + *pos;
+      assert(groups_[index].first == pid);
+      return std::make_optional(index);
+    };
+    if (auto index = in_block(presentPositions_, 0, producedGroupsBegin_)) {
+      return index;
+    }
+    return in_block(producedPositions_, producedGroupsBegin_, groups_.size());
   }
 
   cet::exempt_ptr<Group>
@@ -869,11 +1273,17 @@ namespace art {
         return sp->getGroupLocal(pid);
       }
     }
-    // Try new secondary files
-    while (auto sp = tryNextSecondaryFile()) {
-      auto& new_sp = secondaryPrincipals_.emplace_back(std::move(sp));
-      if (new_sp->presentFromSource(pid)) {
-        return new_sp->getGroupLocal(pid);
+    // Try new secondary files, starting with the one in which the
+    // product was previously found.
+    auto const key = "pid:" + to_string(pid.value());
+    if (auto sp = indexedSecondaryFile(key); sp && sp->presentFromSource(pid)) {
+      return sp->getGroupLocal(pid);
+    }
+    int fileIndex{};
+    while (auto sp = tryNextSecondaryFile(fileIndex)) {
+      if (sp->presentFromSource(pid)) {
+        indexSecondaryFile(key, fileIndex);
+        return sp->getGroupLocal(pid);
       }
     }
     return nullptr;
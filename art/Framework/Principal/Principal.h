@@ -21,10 +21,15 @@
 #include "art/Framework/Principal/Group.h"
 #include "art/Framework/Principal/NoDelayedReader.h"
 #include "art/Framework/Principal/OutputHandle.h"
+#include "art/Framework/Principal/ProductInfo.h"
 #include "art/Framework/Principal/ProductInserter.h"
+#include "art/Framework/Principal/ProductTableIndex.h"
+#include "art/Framework/Principal/ProductTokenCache.h"
+#include "art/Framework/Principal/SelectorMatchCache.h"
 #include "art/Framework/Principal/fwd.h"
 #include "art/Persistency/Common/GroupQueryResult.h"
 #include "art/Persistency/Provenance/fwd.h"
+#include "art/Utilities/fwd.h"
 #include "canvas/Persistency/Common/PrincipalBase.h"
 #include "canvas/Persistency/Common/fwd.h"
 #include "canvas/Persistency/Provenance/BranchType.h"
@@ -36,19 +41,23 @@
 #include "canvas/Persistency/Provenance/type_aliases.h"
 #include "canvas/Utilities/InputTag.h"
 #include "cetlib/exempt_ptr.h"
+#include "hep_concurrency/WaitingTask.h"
 
 #include <atomic>
+#include <cstddef>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace art {
 
   class Principal : public PrincipalBase {
   public:
-    using GroupCollection = std::map<ProductID, std::unique_ptr<Group>>;
+    using GroupCollection = art::GroupCollection;
     using const_iterator = GroupCollection::const_iterator;
     enum class allowed_processes { current_process, input_source, all };
 
@@ -88,6 +97,15 @@ namespace art {
                                 std::string const& label,
                                 std::string const& productInstanceName,
                                 ProcessTag const& processTag) const;
+    // Equivalent to getByLabel for the declared product, but the
+    // products that may satisfy the declaration are looked up only
+    // once for the current product tables and process history (see
+    // ProductTokenCache).  The index is that of the consumes
+    // statement.
+    GroupQueryResult getByToken(ModuleContext const& mc,
+                                WrappedTypeID const& wrapped,
+                                std::size_t index,
+                                ProductInfo const& declared) const;
     std::vector<GroupQueryResult> getMany(ModuleContext const& mc,
                                           WrappedTypeID const& wrapped,
                                           SelectorBase const&,
@@ -142,8 +160,24 @@ namespace art {
     // Read all data products and provenance immediately, if available.
     void readImmediate() const;
 
+    // Used by Worker to read, before the module is run, the products
+    // from the input file that the module consumes.  The doneTask is
+    // notified once they have been read (see
+    // DelayedReader::prefetchAsync).
+    void prefetchAsync(ModuleContext const& mc,
+                       std::vector<ProductTokenCache::Consumed> const& consumed,
+                       hep::concurrency::WaitingTaskPtr doneTask,
+                       GlobalTaskGroup&) const;
+
     ProcessConfiguration const& processConfiguration() const;
 
+    // Used by ProductInserter to lay out the products a module may put
+    // when its context does not.  The table of present products is
+    // also used by EventPrincipal to evict products early (see
+    // ProductEviction).
+    ProductTable const* producedProductTable() const;
+    ProductTable const* presentProductTable() const;
+
     ProcessHistoryID const&
     processHistoryID() const
     {
@@ -153,6 +187,14 @@ namespace art {
     cet::exempt_ptr<ProductProvenance const> branchToProductProvenance(
       ProductID const&) const;
 
+    // Used by Group.  The provenance of event products read from the
+    // input is only read when first needed, and is kept here rather
+    // than in the groups.  Whether a product is available is answered
+    // from a bitmap made at the same time.
+    cet::exempt_ptr<ProductProvenance const> provenanceOnFile(
+      ProductID) const;
+    bool availableOnFile(ProductID) const;
+
     size_t size() const;
 
     const_iterator begin() const;
@@ -180,9 +222,12 @@ namespace art {
     // Used by our ctors.
     void ctor_create_groups(cet::exempt_ptr<ProductTable const>);
     void ctor_read_provenance();
+    void readProvenanceOnce() const;
     void ctor_fetch_process_history(ProcessHistoryID const&);
 
+    std::unique_ptr<Group> recycledOrNewGroup(BranchDescription const&);
     cet::exempt_ptr<Group> getGroupLocal(ProductID const) const;
+    std::optional<std::size_t> groupIndex(ProductID const) const;
 
     std::vector<cet::exempt_ptr<Group>> matchingSequenceFromInputFile(
       ModuleContext const&,
@@ -196,16 +241,38 @@ namespace art {
                       ModuleContext const&,
                       SelectorBase const&,
                       std::vector<cet::exempt_ptr<Group>>& groups) const;
+    std::shared_ptr<SelectorMatchCache::Matches const> selectorMatches(
+      std::vector<ProductID> const& vpid,
+      SelectorBase const& selector,
+      std::string const& key) const;
     size_t findGroupsForProcess(
       std::vector<ProductID> const& vpid,
       ModuleContext const& mc,
       SelectorBase const& selector,
+      std::string const& key,
       std::vector<cet::exempt_ptr<Group>>& groups) const;
     bool producedInProcess(ProductID) const;
     bool presentFromSource(ProductID) const;
-    auto tryNextSecondaryFile() const;
+    // Secondary files are identified by their index in the list of
+    // secondary file names.  The principal read from a given index is
+    // returned, along with the index of the file that follows it.
+    // Returns the principal read from the first secondary file, from
+    // the given index on, that holds this principal's entry, and sets
+    // fileIndex to that file's index.
+    cet::exempt_ptr<Principal> secondaryPrincipal(int first,
+                                                  int& fileIndex) const;
+    cet::exempt_ptr<Principal> tryNextSecondaryFile(int& fileIndex) const;
+    cet::exempt_ptr<Principal> indexedSecondaryFile(
+      std::string const& key) const;
+    void indexSecondaryFile(std::string const& key, int fileIndex) const;
 
     // Implementation of the ProductRetriever API.
+    ProductTokenCache::Candidates const& tokenCandidates(
+      ModuleContext const& mc,
+      std::size_t index,
+      ProductInfo const& declared) const;
+    ProductTokenCache::Resolutions& tokenResolutions() const;
+    void resetTokenResolutions();
     std::vector<cet::exempt_ptr<Group>> findGroupsForProduct(
       ModuleContext const& mc,
       WrappedTypeID const& wrapped,
@@ -226,6 +293,14 @@ namespace art {
     // Used by EndPathExecutor
     void updateSeenRanges(RangeSet const& rs);
 
+    // Used by ~EventPrincipal() so that later principals can reuse
+    // our groups (see GroupPool).
+    void giveGroupsToPool();
+
+    // Used by EventPrincipal to evict products early (see
+    // ProductEviction).
+    void evictProduct(ProductID) const;
+
   private:
     BranchType branchType_{};
     ProcessHistory processHistory_{};
@@ -237,13 +312,25 @@ namespace art {
     std::atomic<ProductTable const*> producedProducts_{nullptr};
     std::atomic<bool> enableLookupOfProducedProducts_{false};
 
-    // Protects access to groups_.
-    mutable std::recursive_mutex groupMutex_{};
-
-    // All of the currently known data products.
-    // tbb::concurrent_unordered_map<ProductID, std::unique_ptr<Group>>
-    // groups_{};
+    // All of the currently known data products.  The groups of the
+    // products present from the source come first, followed by the
+    // groups of the products produced in this process.  Each block is
+    // in the (ProductID) order of its product table, so a group's
+    // position only depends on the product tables.  Groups are added
+    // only while the principal is being set up; afterwards, they may
+    // be looked up without locking.
     GroupCollection groups_{};
+    std::size_t producedGroupsBegin_{};
+
+    // The positions of the products in each block of groups (see
+    // ProductTableIndex).
+    std::shared_ptr<ProductTableIndex::Positions const> presentPositions_{};
+    std::shared_ptr<ProductTableIndex::Positions const> producedPositions_{};
+
+    // Groups taken from the GroupPool, which fillGroup reuses in
+    // order for as long as they match the product descriptions.
+    GroupCollection recycledGroups_{};
+    std::size_t nextRecycledGroup_{};
 
     // Pointer to the reader that will be used to obtain
     // EDProducts from the persistent store.
@@ -259,10 +346,33 @@ namespace art {
     //       the vector.
     mutable std::vector<std::unique_ptr<Principal>> secondaryPrincipals_{};
 
+    // The provenance of event products read from the input, sorted by
+    // ProductID, and whether each group's product is available
+    // according to it.  Both are filled on first use.
+    mutable std::once_flag provenanceRead_{};
+    mutable std::vector<std::unique_ptr<ProductProvenance const>>
+      provenanceOnFile_{};
+    mutable std::vector<bool> availableOnFile_{};
+
+    // The candidates of the consumes statements for the current
+    // product tables and process history, looked up on first use.
+    // Each Resolutions object the principal has used is kept alive,
+    // since a module may still be reading from it when the process
+    // history changes.
+    mutable std::atomic<ProductTokenCache::Resolutions*> tokenResolutions_{
+      nullptr};
+    mutable std::mutex tokenResolutionsMutex_{};
+    mutable std::vector<std::shared_ptr<ProductTokenCache::Resolutions>>
+      usedTokenResolutions_{};
+
     // Index into the secondary file names vector of the next
     // file that a secondary principal should be created from.
     mutable int nextSecondaryFileIdx_{};
 
+    // The principals read from secondary files, keyed by the index of
+    // the file from which each was read.
+    mutable std::map<int, cet::exempt_ptr<Principal>> secondaryFilesRead_{};
+
     RangeSet rangeSet_{RangeSet::invalid()};
   };
 
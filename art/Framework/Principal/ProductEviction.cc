@@ -0,0 +1,124 @@
+#include "art/Framework/Principal/ProductEviction.h"
+// vim: set sw=2 expandtab :
+
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
+#include "range/v3/view.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+namespace {
+  // Whether a module with the consumes declaration may retrieve the
+  // product.  In case of doubt, the answer is yes.
+  bool
+  may_retrieve(art::ProductInfo const& info, art::BranchDescription const& pd)
+  {
+    using art::ProductInfo;
+    auto const& type_name =
+      info.typeID ? info.typeID.friendlyClassName() : info.friendlyClassName;
+    if (info.consumableType == ProductInfo::ConsumableType::Many) {
+      return type_name == pd.friendlyClassName();
+    }
+    // For views, the consumed type is that of the elements, not of the
+    // product.
+    if (info.consumableType == ProductInfo::ConsumableType::Product &&
+        type_name != pd.friendlyClassName()) {
+      return false;
+    }
+    auto const& process_name = info.process.name();
+    return info.label == pd.moduleLabel() &&
+           info.instance == pd.productInstanceName() &&
+           (process_name.empty() || process_name == pd.processName());
+  }
+}
+
+namespace art {
+
+  ProductEviction*
+  ProductEviction::instance()
+  {
+    static ProductEviction me;
+    return &me;
+  }
+
+  size_t
+  ProductEviction::addConsumer(vector<ProductInfo> const& consumed)
+  {
+    lock_guard sentry{mutex_};
+    consumers_.push_back(consumed);
+    plans_.clear();
+    return consumers_.size() - 1;
+  }
+
+  void
+  ProductEviction::addOutputSelection(
+    function<bool(BranchDescription const&)> keeps)
+  {
+    lock_guard sentry{mutex_};
+    outputSelections_.push_back(std::move(keeps));
+    plans_.clear();
+  }
+
+  shared_ptr<ProductEviction::Plan const>
+  ProductEviction::plan(ProductTable const& table)
+  {
+    lock_guard sentry{mutex_};
+    if (auto it = plans_.find(&table); it != plans_.cend()) {
+      return it->second;
+    }
+    Plan result;
+    result.consumed.resize(consumers_.size());
+    for (auto const& pd : table.descriptions | ::ranges::views::values) {
+      if (pd.produced() || pd.dropped()) {
+        continue;
+      }
+      if (any_of(cbegin(outputSelections_),
+                 cend(outputSelections_),
+                 [&pd](auto const& keeps) { return keeps(pd); })) {
+        continue;
+      }
+      auto const position = result.products.size();
+      unsigned count{};
+      for (size_t c = 0; c != consumers_.size(); ++c) {
+        auto const& consumed = consumers_[c];
+        if (any_of(cbegin(consumed), cend(consumed), [&pd](auto const& info) {
+              return may_retrieve(info, pd);
+            })) {
+          result.consumed[c].push_back(position);
+          ++count;
+        }
+      }
+      if (count == 0u) {
+        continue;
+      }
+      result.products.push_back(pd.productID());
+      result.consumerCounts.push_back(count);
+    }
+    auto plan = make_shared<Plan const>(std::move(result));
+    plans_.emplace(&table, plan);
+    return plan;
+  }
+
+  void
+  ProductEviction::invalidate()
+  {
+    lock_guard sentry{mutex_};
+    plans_.clear();
+  }
+
+  void
+  ProductEviction::countEviction()
+  {
+    ++evictions_;
+  }
+
+  size_t
+  ProductEviction::evictions() const
+  {
+    return evictions_.load();
+  }
+
+} // namespace art
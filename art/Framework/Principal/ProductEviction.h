@@ -0,0 +1,98 @@
+#ifndef art_Framework_Principal_ProductEviction_h
+#define art_Framework_Principal_ProductEviction_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// ProductEviction
+//
+// Supports the opt-in early eviction of event products
+// (services.scheduler.evictConsumedProducts).  A product read from
+// the input file is removed from the event as soon as every module
+// that consumes it has run for that event, rather than when the
+// event is done.
+//
+// The following products are never evicted:
+//
+//   - those that an output module writes,
+//   - those that no module declares it consumes, and
+//   - those made in this process, which Group::removeCachedProduct
+//     cannot remove (a module retrieving such a product afterwards
+//     would find it missing, rather than read it again).
+//
+// Each module that consumes event products is a consumer, identified
+// by the position at which it was added.  Which consumers read which
+// products depends only on the product table of the input file, so a
+// plan is made once per table.  The plans are discarded whenever a
+// new input file is opened.
+//
+// A module that retrieves an evicted product without having declared
+// that it consumes it causes the product to be read again.  But such a
+// module may also still be using the product when it is evicted, so
+// correctness relies on complete consumes declarations.
+// ====================================================================
+
+#include "art/Framework/Principal/ProductInfo.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "canvas/Persistency/Provenance/fwd.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace art {
+
+  class ProductEviction {
+  public:
+    ProductEviction(ProductEviction const&) = delete;
+    ProductEviction& operator=(ProductEviction const&) = delete;
+
+    static ProductEviction* instance();
+
+    // Used by the PathManager.  Returns the consumer index for a
+    // module consuming the given event products.
+    std::size_t addConsumer(std::vector<ProductInfo> const& consumed);
+    // Products for which the predicate returns true are never
+    // evicted.
+    void addOutputSelection(
+      std::function<bool(BranchDescription const&)> keeps);
+
+    struct Plan {
+      // The products that may be evicted, and the number of consumers
+      // of each.
+      std::vector<ProductID> products;
+      std::vector<unsigned> consumerCounts;
+      // For each consumer, the positions in 'products' of the
+      // products it consumes.
+      std::vector<std::vector<std::size_t>> consumed;
+    };
+    std::shared_ptr<Plan const> plan(ProductTable const&);
+
+    // Called when the input file changes.
+    void invalidate();
+
+    void countEviction();
+    std::size_t evictions() const;
+
+  private:
+    ProductEviction() = default;
+
+    // Protects access to all of the following, but evictions_.
+    std::mutex mutex_{};
+    std::vector<std::vector<ProductInfo>> consumers_{};
+    std::vector<std::function<bool(BranchDescription const&)>>
+      outputSelections_{};
+    std::map<ProductTable const*, std::shared_ptr<Plan const>> plans_{};
+    std::atomic<std::size_t> evictions_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_ProductEviction_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -6,10 +6,14 @@
 #include "art/Framework/Principal/RangeSetsSupported.h"
 #include "art/Framework/Principal/Selector.h"
 #include "art/Persistency/Provenance/ModuleContext.h"
+#include "art/Persistency/Provenance/ModuleDescription.h"
 #include "art/Persistency/Provenance/ProcessHistoryRegistry.h"
+#include "art/Persistency/Provenance/ProductSlotLayout.h"
 #include "canvas/Persistency/Provenance/Parentage.h"
+#include "canvas/Persistency/Provenance/ParentageRegistry.h"
 #include "canvas/Persistency/Provenance/ProductID.h"
 #include "canvas/Persistency/Provenance/ProductProvenance.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
 #include "canvas/Persistency/Provenance/canonicalProductName.h"
 #include "cetlib/HorizontalRule.h"
 #include "cetlib/exempt_ptr.h"
@@ -19,10 +23,14 @@
 #include "range/v3/view.hpp"
 
 #include <algorithm>
+#include <initializer_list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -32,14 +40,157 @@ using namespace std;
 
 namespace art {
 
-  ProductInserter::~ProductInserter() = default;
+  namespace {
+    // The products put by a module usually have the same parents from
+    // one event to the next.  The ParentageID of a set of parents (an
+    // MD5 digest) is therefore remembered, and the parentage
+    // registered only once, rather than for every product.
+    ParentageID
+    interned_parentage_id(vector<ProductID> const& parents)
+    {
+      // Bounds the memory used by jobs whose parents vary a lot.
+      constexpr size_t max_entries{10000};
+      static shared_mutex mutex;
+      static map<vector<ProductID>, ParentageID> ids;
+      {
+        shared_lock sentry{mutex};
+        if (auto it = ids.find(parents); it != ids.cend()) {
+          return it->second;
+        }
+      }
+      Parentage const parentage{parents};
+      auto const id = parentage.id();
+      ParentageRegistry::emplace(id, parentage);
+      lock_guard sentry{mutex};
+      if (ids.size() < max_entries) {
+        ids.try_emplace(parents, id);
+      }
+      return id;
+    }
+
+    // The products with the module's label and process name in the
+    // given tables.  Only inserters made outside of a worker (e.g. in
+    // tests), whose context carries no layout, need to look for them.
+    shared_ptr<ProductSlotLayout const>
+    slot_layout_from_tables(ModuleDescription const& md,
+                            initializer_list<ProductTable const*> tables)
+    {
+      vector<BranchDescription> products;
+      for (auto const* table : tables) {
+        if (table == nullptr) {
+          continue;
+        }
+        for (auto const& pd : table->descriptions | ::ranges::views::values) {
+          if (pd.moduleLabel() == md.moduleLabel() &&
+              pd.processName() == md.processName()) {
+            products.push_back(pd);
+          }
+        }
+      }
+      return make_shared<ProductSlotLayout const>(move(products));
+    }
+  }
+
+  ProductInserter::~ProductInserter()
+  {
+    delete[] slots_.load();
+  }
 
   ProductInserter::ProductInserter(BranchType const bt,
                                    Principal& principal,
                                    ModuleContext const& mc)
-    : branchType_{bt}, principal_{&principal}, md_{&mc.moduleDescription()}
+    : branchType_{bt}
+    , principal_{&principal}
+    , md_{&mc.moduleDescription()}
+    , layout_{mc.slotLayout() ?
+                mc.slotLayout() :
+                slot_layout_from_tables(*md_,
+                                        {principal.producedProductTable(),
+                                         principal.presentProductTable()})}
+    , pids_{&layout_->pids(bt)}
+    , descriptions_{&layout_->descriptions(bt)}
   {}
 
+  ProductInserter::ProductInserter(ProductInserter&& other) noexcept
+    : branchType_{other.branchType_}
+    , principal_{other.principal_}
+    , md_{other.md_}
+    , layout_{move(other.layout_)}
+    , pids_{other.pids_}
+    , descriptions_{other.descriptions_}
+    , slots_{other.slots_.exchange(nullptr)}
+  {}
+
+  ProductInserter&
+  ProductInserter::operator=(ProductInserter&& other) noexcept
+  {
+    if (this != &other) {
+      branchType_ = other.branchType_;
+      principal_ = other.principal_;
+      md_ = other.md_;
+      layout_ = move(other.layout_);
+      pids_ = other.pids_;
+      descriptions_ = other.descriptions_;
+      delete[] slots_.exchange(other.slots_.exchange(nullptr));
+    }
+    return *this;
+  }
+
+  size_t
+  ProductInserter::slotIndex_(TypeID const& type, string const& instance) const
+  {
+    auto const product_name = canonicalProductName(type.friendlyClassName(),
+                                                   md_->moduleLabel(),
+                                                   instance,
+                                                   md_->processName());
+    ProductID const pid{product_name};
+    auto const& pids = *pids_;
+    auto it = lower_bound(pids.cbegin(), pids.cend(), pid);
+    if (it != pids.cend() && *it == pid) {
+      auto const index = static_cast<size_t>(it - pids.cbegin());
+      // Assns(A,B) and Assns(B,A) have the same ProductID but not the
+      // same class name.
+      if ((*descriptions_)[index].producedClassName() == type.className()) {
+        return index;
+      }
+    }
+    // Throws the usual error if no such product is registered.
+    auto const& bd = getProductDescription_(type, instance, true);
+    throw Exception(errors::ProductPutFailure)
+      << "The following product was not declared with 'produces' by the\n"
+      << "module labeled '" << md_->moduleLabel() << "':\n"
+      << bd;
+  }
+
+  void
+  ProductInserter::putSlot_(size_t const index,
+                            unique_ptr<EDProduct>&& product,
+                            RangeSet const& rs)
+  {
+    auto* slots = slots_.load();
+    if (slots == nullptr) {
+      auto made = new Slot[pids_->size()];
+      if (slots_.compare_exchange_strong(slots, made)) {
+        slots = made;
+      } else {
+        delete[] made;
+      }
+    }
+    auto& slot = slots[index];
+    if (slot.filled.exchange(true)) {
+      constexpr cet::HorizontalRule rule{30};
+      throw Exception(errors::ProductPutFailure)
+        << "Attempt to put multiple products with the following descriptions.\n"
+        << "Each product must be unique.\n"
+        << rule('=') << '\n'
+        << (*descriptions_)[index] << rule('=') << '\n';
+    }
+    slot.product = move(product);
+    if (detail::range_sets_supported(branchType_)) {
+      slot.rangeSet = make_unique<RangeSet>(rs);
+    }
+  }
+
   void
   ProductInserter::commitProducts(
     bool const checkProducts,
@@ -47,11 +198,14 @@ namespace art {
     std::vector<ProductID> retrievedPIDs)
   {
     assert(branchType_ == InEvent);
-    std::lock_guard lock{*mutex_};
+    auto* slots = slots_.load();
     if (checkProducts) {
       vector<string> missing;
-      for (auto const& [typeLabel, bd] : *expectedProducts) {
-        if (putProducts_.find(typeLabel) != putProducts_.cend()) {
+      auto const& pids = *pids_;
+      for (auto const& bd : *expectedProducts | ::ranges::views::values) {
+        auto it = lower_bound(pids.cbegin(), pids.cend(), bd.productID());
+        if (slots != nullptr && it != pids.cend() && *it == bd.productID() &&
+            slots[it - pids.cbegin()].filled.load()) {
           continue;
         }
         ostringstream desc;
@@ -72,31 +226,49 @@ namespace art {
       }
     }
 
-    for (auto&& [product, pd, rs] : putProducts_ | ::ranges::views::values) {
+    if (slots == nullptr) {
+      return;
+    }
+    // All products put by the module share the same parentage.
+    optional<ParentageID> parentageID;
+    for (size_t i{}, n{pids_->size()}; i != n; ++i) {
+      auto& slot = slots[i];
+      if (!slot.filled.exchange(false)) {
+        continue;
+      }
+      if (!parentageID) {
+        parentageID = interned_parentage_id(retrievedPIDs);
+      }
+      auto const& pd = (*descriptions_)[i];
       auto pp = make_unique<ProductProvenance const>(
-        pd.productID(), productstatus::present(), retrievedPIDs);
+        pd.productID(), productstatus::present(), *parentageID);
       principal_->put(pd,
                       std::move(pp),
-                      std::move(product),
+                      std::move(slot.product),
                       make_unique<RangeSet>(RangeSet::invalid()));
     }
-    putProducts_.clear();
   }
 
   void
   ProductInserter::commitProducts()
   {
-    std::lock_guard lock{*mutex_};
-    for (auto&& [product, pd, range_set] :
-         putProducts_ | ::ranges::views::values) {
+    auto* slots = slots_.load();
+    if (slots == nullptr) {
+      return;
+    }
+    for (size_t i{}, n{pids_->size()}; i != n; ++i) {
+      auto& slot = slots[i];
+      if (!slot.filled.exchange(false)) {
+        continue;
+      }
+      auto const& pd = (*descriptions_)[i];
       auto pp = make_unique<ProductProvenance const>(pd.productID(),
                                                      productstatus::present());
-      auto rs = detail::range_sets_supported(branchType_) ?
-                  make_unique<RangeSet>(std::move(range_set)) :
-                  make_unique<RangeSet>(RangeSet::invalid());
-      principal_->put(pd, std::move(pp), std::move(product), std::move(rs));
+      auto rs = slot.rangeSet ? std::move(slot.rangeSet) :
+                                make_unique<RangeSet>(RangeSet::invalid());
+      principal_->put(
+        pd, std::move(pp), std::move(slot.product), std::move(rs));
     }
-    putProducts_.clear();
   }
 
   BranchDescription const&
@@ -105,7 +277,6 @@ namespace art {
     string const& instance,
     bool const alwaysEnableLookupOfProducedProducts /*= false*/) const
   {
-    std::lock_guard lock{*mutex_};
     auto const product_name = canonicalProductName(type.friendlyClassName(),
                                                    md_->moduleLabel(),
                                                    instance,
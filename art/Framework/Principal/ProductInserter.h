@@ -4,7 +4,6 @@
 
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Principal/Provenance.h"
-#include "art/Framework/Principal/detail/type_label_for.h"
 #include "art/Framework/Principal/fwd.h"
 #include "art/Persistency/Common/GroupQueryResult.h"
 #include "art/Persistency/Provenance/fwd.h"
@@ -22,11 +21,11 @@
 #include "cetlib/exempt_ptr.h"
 #include "cetlib_except/exception.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -43,8 +42,8 @@ namespace art {
 
     ProductInserter(ProductInserter const&) = delete;
     ProductInserter& operator=(ProductInserter const&) = delete;
-    ProductInserter(ProductInserter&&) = default;
-    ProductInserter& operator=(ProductInserter&&) = default;
+    ProductInserter(ProductInserter&&) noexcept;
+    ProductInserter& operator=(ProductInserter&&) noexcept;
 
     // Product insertion - all processing levels
     template <typename PROD>
@@ -64,12 +63,19 @@ namespace art {
       std::vector<ProductID> retrievedPIDs);
 
   private:
-    struct PMValue {
-      std::unique_ptr<EDProduct> product;
-      BranchDescription const& description;
-      RangeSet rangeSet;
+    // A put product is stored in the slot of its description.
+    struct Slot {
+      std::atomic<bool> filled{false};
+      std::unique_ptr<EDProduct> product{};
+      std::unique_ptr<RangeSet> rangeSet{};
     };
 
+    std::size_t slotIndex_(TypeID const& type,
+                           std::string const& instance) const;
+    void putSlot_(std::size_t index,
+                  std::unique_ptr<EDProduct>&& product,
+                  RangeSet const& rs);
+
     BranchDescription const& getProductDescription_(
       TypeID const& type,
       std::string const& instance,
@@ -78,10 +84,6 @@ namespace art {
     EDProductGetter const* productGetter_(ProductID id) const;
     Provenance provenance_(ProductID id) const;
 
-    // Protects use of retrievedProducts_ and putProducts_.
-    mutable std::unique_ptr<std::recursive_mutex> mutex_{
-      std::make_unique<std::recursive_mutex>()};
-
     // Is this an Event, a Run, a SubRun, or a Results.
     BranchType branchType_;
 
@@ -91,8 +93,16 @@ namespace art {
     // The module we were created for.
     ModuleDescription const* md_;
 
-    // The set of products which have been put by the user.
-    std::map<TypeLabel, PMValue> putProducts_{};
+    // The products the module may put, of this branch type, in
+    // ProductID order.
+    std::shared_ptr<ProductSlotLayout const> layout_;
+    std::vector<ProductID> const* pids_;
+    std::vector<BranchDescription> const* descriptions_;
+
+    // The products which have been put by the user, one slot per
+    // product the module may put.  The slots are made on the first
+    // put, as most modules (e.g. analyzers) put nothing.
+    std::atomic<Slot*> slots_{nullptr};
   };
 
   // =======================================================================
@@ -118,29 +128,16 @@ namespace art {
         << "The specified productInstanceName was '" << instance << "'.\n";
     }
 
-    std::lock_guard lock{*mutex_};
-    auto const& bd = getProductDescription_(tid, instance, true);
-    assert(bd.productID() != ProductID::invalid());
-    auto const typeLabel =
-      detail::type_label_for(tid, instance, SupportsView<PROD>::value, *md_);
+    auto const index = slotIndex_(tid, instance);
+    auto const pid = (*pids_)[index];
+    assert(pid != ProductID::invalid());
     auto wp = std::make_unique<Wrapper<PROD>>(std::move(edp));
 
     // Mind the product ownership!  The wrapper is the final resting
     // place of the product before it is taken out of memory.
     cet::exempt_ptr<PROD const> product{wp->product()};
-    auto result =
-      putProducts_.try_emplace(typeLabel, PMValue{std::move(wp), bd, rs})
-        .second;
-    if (!result) {
-      constexpr cet::HorizontalRule rule{30};
-      throw Exception(errors::ProductPutFailure)
-        << "Attempt to put multiple products with the following descriptions.\n"
-        << "Each product must be unique.\n"
-        << rule('=') << '\n'
-        << bd << rule('=') << '\n';
-    }
-    return PutHandle{
-      product.get(), productGetter_(bd.productID()), bd.productID()};
+    putSlot_(index, std::move(wp), rs);
+    return PutHandle{product.get(), productGetter_(pid), pid};
   }
 
 } // namespace art
@@ -20,6 +20,7 @@
 #include "fhiclcpp/ParameterSetRegistry.h"
 #include "fhiclcpp/fwd.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -39,6 +40,8 @@ namespace art {
     , principal_{principal}
     , mc_{mc}
     , md_{mc.moduleDescription()}
+    , consumables_{ConsumesInfo::instance()->sealedConsumables(
+        md_.moduleLabel())}
     , recordParents_{recordParents}
   {}
 
@@ -70,8 +73,8 @@ namespace art {
   ProductRetriever::retrievedPIDs() const
   {
     std::lock_guard lock{mutex_};
-    return std::vector<ProductID>(begin(retrievedProducts_),
-                                  end(retrievedProducts_));
+    compactRetrievedProducts_();
+    return retrievedProducts_;
   }
 
   std::optional<Provenance const>
@@ -104,12 +107,32 @@ namespace art {
       // If the product retrieved is transient, don't use its
       // ProductID; use the ProductID's of its parents.
       auto const& parents = grp->productProvenance()->parentage().parents();
-      retrievedProducts_.insert(cbegin(parents), cend(parents));
+      retrievedProducts_.insert(
+        end(retrievedProducts_), cbegin(parents), cend(parents));
     } else {
-      retrievedProducts_.insert(grp->productDescription().productID());
+      auto const pid = grp->productDescription().productID();
+      if (!retrievedProducts_.empty() && retrievedProducts_.back() == pid) {
+        return;
+      }
+      retrievedProducts_.push_back(pid);
+    }
+    // A module that retrieves the same products over and over must
+    // not grow the list without bound.
+    if (retrievedProducts_.size() >= 2 * compactedSize_ + 64) {
+      compactRetrievedProducts_();
     }
   }
 
+  void
+  ProductRetriever::compactRetrievedProducts_() const
+  {
+    std::sort(begin(retrievedProducts_), end(retrievedProducts_));
+    retrievedProducts_.erase(
+      std::unique(begin(retrievedProducts_), end(retrievedProducts_)),
+      end(retrievedProducts_));
+    compactedSize_ = retrievedProducts_.size();
+  }
+
   cet::exempt_ptr<Group const>
   ProductRetriever::getContainerForView_(TypeID const& typeID,
                                          std::string const& moduleLabel,
@@ -126,7 +149,8 @@ namespace art {
                   typeID,
                   moduleLabel,
                   productInstanceName,
-                  processTag});
+                  processTag},
+      consumables_);
     // Fetch the specified data products, which must be containers.
     auto const groups = principal_.getMatchingSequence(
       mc_,
@@ -209,7 +233,8 @@ namespace art {
                             tag.label(),
                             tag.instance(),
                             processTag};
-    ConsumesInfo::instance()->validateConsumedProduct(branchType_, md_, pinfo);
+    ConsumesInfo::instance()->validateConsumedProduct(
+      branchType_, md_, pinfo, consumables_);
     GroupQueryResult qr = principal_.getByLabel(
       mc_, wrapped, tag.label(), tag.instance(), processTag);
     bool const ok = qr.succeeded() && !qr.failed();
@@ -219,6 +244,32 @@ namespace art {
     return qr;
   }
 
+  GroupQueryResult
+  ProductRetriever::getByToken_(WrappedTypeID const& wrapped,
+                                InputTag const& tag) const
+  {
+    std::lock_guard lock{mutex_};
+    ProcessTag const processTag{tag.process(), md_.processName()};
+    ProductInfo const pinfo{ProductInfo::ConsumableType::Product,
+                            wrapped.product_type,
+                            tag.label(),
+                            tag.instance(),
+                            processTag};
+    auto const index = ConsumesInfo::instance()->validateConsumedProduct(
+      branchType_, md_, pinfo, consumables_);
+    // A token whose product has not been declared is looked up in
+    // full, as for an input tag.
+    GroupQueryResult qr =
+      index ? principal_.getByToken(mc_, wrapped, *index, pinfo) :
+              principal_.getByLabel(
+                mc_, wrapped, tag.label(), tag.instance(), processTag);
+    bool const ok = qr.succeeded() && !qr.failed();
+    if (recordParents_ && ok) {
+      recordAsParent_(qr.result());
+    }
+    return qr;
+  }
+
   GroupQueryResult
   ProductRetriever::getBySelector_(WrappedTypeID const& wrapped,
                                    SelectorBase const& sel) const
@@ -254,7 +305,8 @@ namespace art {
     ConsumesInfo::instance()->validateConsumedProduct(
       branchType_,
       md_,
-      ProductInfo{ProductInfo::ConsumableType::Many, wrapped.product_type});
+      ProductInfo{ProductInfo::ConsumableType::Many, wrapped.product_type},
+      consumables_);
     ProcessTag const processTag{"", md_.processName()};
     auto qrs = principal_.getMany(mc_, wrapped, sel, processTag);
     for (auto const& qr : qrs) {
@@ -2,6 +2,7 @@
 #define art_Framework_Principal_ProductRetriever_h
 // vim: set sw=2 expandtab :
 
+#include "art/Framework/Principal/ConsumesInfo.h"
 #include "art/Framework/Principal/Group.h"
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Principal/ProcessTag.h"
@@ -165,6 +166,7 @@ namespace art {
 
   private:
     void recordAsParent_(cet::exempt_ptr<Group const> grp) const;
+    void compactRetrievedProducts_() const;
     cet::exempt_ptr<Group const> getContainerForView_(
       TypeID const&,
       std::string const& moduleLabel,
@@ -176,6 +178,8 @@ namespace art {
                                         SelectorBase const& selector) const;
     GroupQueryResult getByLabel_(WrappedTypeID const& wrapped,
                                  InputTag const& tag) const;
+    GroupQueryResult getByToken_(WrappedTypeID const& wrapped,
+                                 InputTag const& tag) const;
     GroupQueryResult getBySelector_(WrappedTypeID const& wrapped,
                                     SelectorBase const& selector) const;
     GroupQueryResult getByProductID_(ProductID productID) const;
@@ -197,15 +201,22 @@ namespace art {
     // The module we were created for.
     ModuleDescription const& md_;
 
+    // What the module consumes, or null if the consumes information
+    // has not yet been sealed.
+    ConsumesInfo::SealedConsumables const* const consumables_;
+
     // If we are constructed as a non-const Event, then we can be used
     // to put products into the Principal, so we need to record
     // retrieved products into retrievedProducts_ to track parentage
     // of any products we put.
     bool const recordParents_;
 
-    // The set of products retrieved from the principal.  We use this
-    // to track parentage of any products we put.
-    mutable std::set<ProductID> retrievedProducts_{};
+    // The products retrieved from the principal.  We use this to
+    // track parentage of any products we put.  They are recorded in
+    // retrieval order, and only sorted and made unique when the
+    // parentage is needed, or when the list has grown too much.
+    mutable std::vector<ProductID> retrievedProducts_{};
+    mutable std::size_t compactedSize_{};
   };
 
   template <typename PROD>
@@ -259,7 +270,8 @@ namespace art {
   Handle<PROD>
   ProductRetriever::getHandle(ProductToken<PROD> const& token) const
   {
-    return getHandle<PROD>(token.inputTag());
+    auto qr = getByToken_(WrappedTypeID::make<PROD>(), token.inputTag());
+    return Handle<PROD>{qr};
   }
 
   // =========================================================================
@@ -275,7 +287,8 @@ namespace art {
   ValidHandle<PROD>
   ProductRetriever::getValidHandle(ProductToken<PROD> const& token) const
   {
-    return getValidHandle<PROD>(token.inputTag());
+    auto h = getHandle(token);
+    return ValidHandle{h.product(), h.productGetter(), *h.provenance()};
   }
 
   template <typename PROD>
@@ -327,8 +340,10 @@ namespace art {
     if (recordParents_) {
       recordAsParent_(grp);
     }
-    auto const view = grp->uniqueProduct()->getView();
+    std::vector<void const*> scratch;
+    auto const& view = grp->productView(scratch);
     std::vector<ELEMENT const*> castedView;
+    castedView.reserve(view.size());
     for (auto p : view) {
       castedView.push_back(static_cast<ELEMENT const*>(p));
     }
@@ -376,8 +391,10 @@ namespace art {
     if (recordParents_) {
       recordAsParent_(grp);
     }
-    auto const view = grp->uniqueProduct()->getView();
+    std::vector<void const*> scratch;
+    auto const& view = grp->productView(scratch);
     std::vector<ELEMENT const*> castedView;
+    castedView.reserve(view.size());
     for (auto p : view) {
       castedView.push_back(static_cast<ELEMENT const*>(p));
     }
@@ -0,0 +1,75 @@
+#include "art/Framework/Principal/ProductTableIndex.h"
+// vim: set sw=2 expandtab :
+
+#include "range/v3/view.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+using namespace std;
+
+namespace art {
+
+  ProductTableIndex::Positions::Positions(ProductTable const& table)
+  {
+    pids_.reserve(table.descriptions.size());
+    positions_.reserve(table.descriptions.size());
+    for (auto const pid : table.descriptions | ::ranges::views::keys) {
+      positions_.emplace(pid, pids_.size());
+      pids_.push_back(pid);
+    }
+  }
+
+  bool
+  ProductTableIndex::Positions::indexes(ProductTable const& table) const
+  {
+    auto const pids = table.descriptions | ::ranges::views::keys;
+    return pids_.size() == table.descriptions.size() &&
+           std::equal(pids_.cbegin(), pids_.cend(), pids.begin());
+  }
+
+  optional<size_t>
+  ProductTableIndex::Positions::find(ProductID const pid) const
+  {
+    auto it = positions_.find(pid);
+    if (it == positions_.cend()) {
+      return nullopt;
+    }
+    return make_optional(it->second);
+  }
+
+  ProductTableIndex*
+  ProductTableIndex::instance()
+  {
+    static ProductTableIndex me;
+    return &me;
+  }
+
+  shared_ptr<ProductTableIndex::Positions const>
+  ProductTableIndex::positions(ProductTable const& table)
+  {
+    {
+      shared_lock sentry{mutex_};
+      if (auto it = entries_.find(&table); it != entries_.cend() &&
+                                           it->second->indexes(table)) {
+        return it->second;
+      }
+    }
+    // The positions are computed outside of the lock; if another
+    // thread indexed the same table in the meantime, either copy will
+    // do.
+    auto positions = make_shared<Positions const>(table);
+    lock_guard sentry{mutex_};
+    entries_.insert_or_assign(&table, positions);
+    return positions;
+  }
+
+  void
+  ProductTableIndex::invalidate()
+  {
+    lock_guard sentry{mutex_};
+    entries_.clear();
+  }
+
+} // namespace art
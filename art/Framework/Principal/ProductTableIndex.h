@@ -0,0 +1,84 @@
+#ifndef art_Framework_Principal_ProductTableIndex_h
+#define art_Framework_Principal_ProductTableIndex_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// ProductTableIndex
+//
+// A principal keeps its groups in the (ProductID) order of the
+// descriptions of its product tables, so the position of a group only
+// depends on the table.  This index maps each ProductID of a table to
+// that position, so that a group is found with one hash lookup rather
+// than a binary search over the groups.
+//
+// The positions are computed once per table and shared by all of the
+// principals made from it.  Entries are keyed on the address of the
+// table; the ProductIDs are kept alongside, so that a different table
+// that happens to reuse the address is indexed anew.  The index is
+// emptied whenever a new input file is opened.
+// ====================================================================
+
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+
+  class ProductTableIndex {
+  public:
+    ProductTableIndex(ProductTableIndex const&) = delete;
+    ProductTableIndex& operator=(ProductTableIndex const&) = delete;
+
+    class Positions {
+    public:
+      explicit Positions(ProductTable const&);
+
+      // Whether the descriptions of the table are those indexed.
+      bool indexes(ProductTable const&) const;
+
+      // Position of the product among the descriptions of the table.
+      std::optional<std::size_t> find(ProductID) const;
+
+    private:
+      struct PIDHash {
+        std::size_t
+        operator()(ProductID const pid) const noexcept
+        {
+          return std::hash<ProductID::value_type>{}(pid.value());
+        }
+      };
+
+      std::vector<ProductID> pids_;
+      std::unordered_map<ProductID, std::size_t, PIDHash> positions_;
+    };
+
+    static ProductTableIndex* instance();
+
+    std::shared_ptr<Positions const> positions(ProductTable const&);
+
+    // Called when the input file changes.
+    void invalidate();
+
+  private:
+    ProductTableIndex() = default;
+
+    // Protects access to entries_.
+    mutable std::shared_mutex mutex_{};
+    std::unordered_map<ProductTable const*, std::shared_ptr<Positions const>>
+      entries_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_ProductTableIndex_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -0,0 +1,85 @@
+#include "art/Framework/Principal/ProductTokenCache.h"
+// vim: set sw=2 expandtab :
+
+#include "art/Framework/Principal/ConsumesInfo.h"
+
+#include <cassert>
+#include <mutex>
+#include <utility>
+
+using namespace std;
+
+namespace art {
+
+  ProductTokenCache::Resolutions::Resolutions(size_t const numConsumables)
+    : candidates_(numConsumables)
+  {
+    for (auto& candidates : candidates_) {
+      candidates = nullptr;
+    }
+  }
+
+  ProductTokenCache::Resolutions::~Resolutions()
+  {
+    for (auto& candidates : candidates_) {
+      delete candidates.load();
+    }
+  }
+
+  ProductTokenCache::Candidates const*
+  ProductTokenCache::Resolutions::find(size_t const index) const
+  {
+    assert(index < candidates_.size());
+    return candidates_[index].load(memory_order_acquire);
+  }
+
+  ProductTokenCache::Candidates const&
+  ProductTokenCache::Resolutions::insert(size_t const index,
+                                         Candidates&& candidates)
+  {
+    assert(index < candidates_.size());
+    auto inserted = make_unique<Candidates const>(move(candidates));
+    Candidates const* expected{nullptr};
+    if (candidates_[index].compare_exchange_strong(expected,
+                                                   inserted.get(),
+                                                   memory_order_acq_rel,
+                                                   memory_order_acquire)) {
+      return *inserted.release();
+    }
+    return *expected;
+  }
+
+  ProductTokenCache*
+  ProductTokenCache::instance()
+  {
+    static ProductTokenCache me;
+    return &me;
+  }
+
+  shared_ptr<ProductTokenCache::Resolutions>
+  ProductTokenCache::resolutions(Tables const& tables)
+  {
+    key_t const key{tables.present, tables.produced, tables.processHistoryID};
+    {
+      shared_lock sentry{mutex_};
+      if (auto it = resolutions_.find(key); it != resolutions_.cend()) {
+        return it->second;
+      }
+    }
+    lock_guard sentry{mutex_};
+    auto& result = resolutions_[key];
+    if (!result) {
+      result = make_shared<Resolutions>(
+        ConsumesInfo::instance()->numConsumables());
+    }
+    return result;
+  }
+
+  void
+  ProductTokenCache::invalidate()
+  {
+    lock_guard sentry{mutex_};
+    resolutions_.clear();
+  }
+
+} // namespace art
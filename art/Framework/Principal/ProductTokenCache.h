@@ -0,0 +1,112 @@
+#ifndef art_Framework_Principal_ProductTokenCache_h
+#define art_Framework_Principal_ProductTokenCache_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// ProductTokenCache
+//
+// Remembers, for each consumes statement, the groups of the products
+// that may satisfy it.  Those candidates depend only on the product
+// tables and the process history of the principal, and not on the
+// event itself.  They are therefore looked up once per (product
+// tables, process history) combination, rather than each time a
+// product is retrieved.
+//
+// The candidates for one such combination are kept in a Resolutions
+// object, indexed by the dense index that ConsumesInfo gives each
+// consumes statement once it is sealed.  A principal looks up its
+// Resolutions object once, after which the candidates are read and
+// filled in without locking.  The cache is emptied whenever a new
+// input file is opened; principals that still hold a Resolutions
+// object keep it alive.
+// ====================================================================
+
+#include "art/Framework/Principal/ProductInfo.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "canvas/Persistency/Provenance/ProcessHistoryID.h"
+#include "canvas/Persistency/Provenance/fwd.h"
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <tuple>
+#include <vector>
+
+namespace art {
+
+  class ProductTokenCache {
+  public:
+    ProductTokenCache(ProductTokenCache const&) = delete;
+    ProductTokenCache& operator=(ProductTokenCache const&) = delete;
+
+    // The state of a principal that determines which products may
+    // satisfy a consumes statement.  The produced-products table is
+    // null if the lookup of produced products is not yet enabled.
+    struct Tables {
+      ProductTable const* present;
+      ProductTable const* produced;
+      ProcessHistoryID const& processHistoryID;
+    };
+
+    // A candidate is the position of a group in the principal, which
+    // only depends on the product tables.  The candidates are in the
+    // order in which Principal::findGroupsForProduct would find them.
+    struct Candidate {
+      std::size_t index;
+      ProductID pid;
+    };
+    using Candidates = std::vector<Candidate>;
+
+    // A consumes statement together with its index (see
+    // ConsumesInfo::SealedConsumables).
+    struct Consumed {
+      std::size_t index;
+      ProductInfo info;
+    };
+
+    // The candidates of each consumes statement, for one combination
+    // of product tables and process history.
+    class Resolutions {
+    public:
+      explicit Resolutions(std::size_t numConsumables);
+      ~Resolutions();
+      Resolutions(Resolutions const&) = delete;
+      Resolutions& operator=(Resolutions const&) = delete;
+
+      // Returns null if the candidates have not yet been looked up.
+      Candidates const* find(std::size_t index) const;
+      // If another thread has inserted candidates for the same index
+      // in the meantime, those are kept and returned instead.
+      Candidates const& insert(std::size_t index, Candidates&&);
+
+    private:
+      std::vector<std::atomic<Candidates const*>> candidates_;
+    };
+
+    static ProductTokenCache* instance();
+
+    std::shared_ptr<Resolutions> resolutions(Tables const&);
+
+    // Called when the input file changes.
+    void invalidate();
+
+  private:
+    ProductTokenCache() = default;
+
+    using key_t =
+      std::tuple<ProductTable const*, ProductTable const*, ProcessHistoryID>;
+
+    // Protects access to resolutions_.
+    mutable std::shared_mutex mutex_{};
+    std::map<key_t, std::shared_ptr<Resolutions>> resolutions_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_ProductTokenCache_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -0,0 +1,46 @@
+#include "art/Framework/Principal/SecondaryFileIndex.h"
+// vim: set sw=2 expandtab :
+
+#include <mutex>
+
+using namespace std;
+
+namespace art {
+
+  SecondaryFileIndex*
+  SecondaryFileIndex::instance()
+  {
+    static SecondaryFileIndex me;
+    return &me;
+  }
+
+  optional<int>
+  SecondaryFileIndex::find(BranchType const bt, string const& key) const
+  {
+    shared_lock sentry{mutex_};
+    auto const& entries = entries_[bt];
+    if (auto it = entries.find(key); it != entries.cend()) {
+      return make_optional(it->second);
+    }
+    return nullopt;
+  }
+
+  void
+  SecondaryFileIndex::insert(BranchType const bt,
+                             string const& key,
+                             int const fileIndex)
+  {
+    lock_guard sentry{mutex_};
+    entries_[bt].insert_or_assign(key, fileIndex);
+  }
+
+  void
+  SecondaryFileIndex::invalidate()
+  {
+    lock_guard sentry{mutex_};
+    for (auto& entries : entries_) {
+      entries.clear();
+    }
+  }
+
+} // namespace art
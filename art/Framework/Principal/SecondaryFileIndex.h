@@ -0,0 +1,59 @@
+#ifndef art_Framework_Principal_SecondaryFileIndex_h
+#define art_Framework_Principal_SecondaryFileIndex_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// SecondaryFileIndex
+//
+// Remembers, for each product lookup that had to be satisfied from a
+// secondary file, the index of the secondary file in which the
+// products were found.  Which products a file holds does not depend
+// on the event, so the principals of later events open that file
+// directly, rather than opening each of the preceding secondary files
+// in turn.
+//
+// Lookups that no secondary file satisfies are not remembered: a
+// secondary file may also be passed over because it does not contain
+// the event at hand.  The index is emptied whenever a new input file
+// is opened, as the secondary files belong to the primary one.
+// ====================================================================
+
+#include "canvas/Persistency/Provenance/BranchType.h"
+
+#include <array>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace art {
+
+  class SecondaryFileIndex {
+  public:
+    SecondaryFileIndex(SecondaryFileIndex const&) = delete;
+    SecondaryFileIndex& operator=(SecondaryFileIndex const&) = delete;
+
+    static SecondaryFileIndex* instance();
+
+    std::optional<int> find(BranchType, std::string const& key) const;
+    void insert(BranchType, std::string const& key, int fileIndex);
+
+    // Called when the input file changes.
+    void invalidate();
+
+  private:
+    SecondaryFileIndex() = default;
+
+    // Protects access to entries_.
+    mutable std::shared_mutex mutex_{};
+    std::array<std::unordered_map<std::string, int>, NumBranchTypes>
+      entries_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_SecondaryFileIndex_h */
+
+// Local Variables:
+// mode: c++
+// End:
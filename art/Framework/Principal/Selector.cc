@@ -15,4 +15,10 @@ namespace art {
     return sel_->print(indent);
   }
 
+  std::string const&
+  Selector::doCacheKey() const
+  {
+    return key_;
+  }
+
 } // namespace art
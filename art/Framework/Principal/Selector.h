@@ -63,7 +63,7 @@ namespace art {
   class ProcessNameSelector : public SelectorBase {
   public:
     explicit ProcessNameSelector(std::string const& pn)
-      : pn_{pn.empty() ? std::string{"*"} : pn}
+      : pn_{pn.empty() ? std::string{"*"} : pn}, key_{"process:" + pn_ + ';'}
     {}
 
   private:
@@ -85,7 +85,14 @@ namespace art {
       return result;
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
     std::string pn_;
+    std::string key_;
   };
 
   //------------------------------------------------------------------
@@ -95,7 +102,9 @@ namespace art {
 
   class ProductInstanceNameSelector : public SelectorBase {
   public:
-    explicit ProductInstanceNameSelector(std::string const& pin) : pin_{pin} {}
+    explicit ProductInstanceNameSelector(std::string const& pin)
+      : pin_{pin}, key_{"instance:" + pin_ + ';'}
+    {}
 
   private:
     bool
@@ -110,7 +119,14 @@ namespace art {
       return indent + "Product instance name: '" + pin_ + '\'';
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
     std::string pin_;
+    std::string key_;
   };
 
   //------------------------------------------------------------------
@@ -120,7 +136,9 @@ namespace art {
 
   class ModuleLabelSelector : public SelectorBase {
   public:
-    explicit ModuleLabelSelector(std::string const& label) : label_{label} {}
+    explicit ModuleLabelSelector(std::string const& label)
+      : label_{label}, key_{"label:" + label_ + ';'}
+    {}
 
   private:
     bool
@@ -135,7 +153,14 @@ namespace art {
       return indent + "Module label: '" + label_ + '\'';
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
     std::string label_;
+    std::string key_;
   };
 
   //------------------------------------------------------------------
@@ -155,6 +180,13 @@ namespace art {
     {
       return {};
     }
+
+    std::string const&
+    doCacheKey() const override
+    {
+      static std::string const key{"*;"};
+      return key;
+    }
   };
 
   // Select products based on the result of a filter function (or
@@ -200,7 +232,7 @@ namespace art {
                                                       operator*()),
                                              art::InputTag>>* dummy
       [[maybe_unused]] = nullptr)
-      : tags_{begin, end}, description_{description}
+      : tags_{begin, end}, description_{description}, key_{cache_key(tags_)}
     {}
 
     std::vector<art::InputTag> const&
@@ -228,10 +260,45 @@ namespace art {
       return indent + description_;
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
+    static std::string
+    cache_key(std::vector<art::InputTag> const& tags)
+    {
+      std::string result{"tags:"};
+      for (auto const& tag : tags) {
+        result +=
+          tag.label() + ':' + tag.instance() + ':' + tag.process() + ',';
+      }
+      return result + ';';
+    }
+
     std::vector<art::InputTag> const tags_;
     std::string description_;
+    std::string key_;
   };
 
+  namespace detail {
+    // The cache key of a selector composed from others: empty if that
+    // of any of them is.
+    template <typename... Keys>
+    std::string
+    composed_cache_key(char const* op, Keys const&... keys)
+    {
+      if ((keys.empty() || ...)) {
+        return {};
+      }
+      std::string result{op};
+      result += '(';
+      ((result += keys), ...);
+      return result + ')';
+    }
+  }
+
   //----------------------------------------------------------
   // AndHelper template.
   // Used to form expressions involving && between other selectors.
@@ -240,7 +307,11 @@ namespace art {
   template <typename A, typename B>
   class AndHelper : public SelectorBase {
   public:
-    AndHelper(A const& a, B const& b) : a_{a}, b_{b} {}
+    AndHelper(A const& a, B const& b)
+      : a_{a}
+      , b_{b}
+      , key_{detail::composed_cache_key("and", a_.cacheKey(), b_.cacheKey())}
+    {}
 
   private:
     bool
@@ -255,8 +326,15 @@ namespace art {
       return a_.print(indent) + '\n' + b_.print(indent);
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
     A a_;
     B b_;
+    std::string key_;
   };
 
   template <typename A, typename B>
@@ -274,7 +352,11 @@ namespace art {
   template <typename A, typename B>
   class OrHelper : public SelectorBase {
   public:
-    OrHelper(A const& a, B const& b) : a_{a}, b_{b} {}
+    OrHelper(A const& a, B const& b)
+      : a_{a}
+      , b_{b}
+      , key_{detail::composed_cache_key("or", a_.cacheKey(), b_.cacheKey())}
+    {}
 
   private:
     bool
@@ -294,8 +376,15 @@ namespace art {
       return result;
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
     A a_;
     B b_;
+    std::string key_;
   };
 
   template <typename A, typename B>
@@ -313,7 +402,9 @@ namespace art {
   template <typename A>
   class NotHelper : public SelectorBase {
   public:
-    explicit NotHelper(A const& a) : a_{a} {}
+    explicit NotHelper(A const& a)
+      : a_{a}, key_{detail::composed_cache_key("not", a_.cacheKey())}
+    {}
 
   private:
     bool
@@ -330,7 +421,15 @@ namespace art {
       result += indent + ']';
       return result;
     }
+
+    std::string const&
+    doCacheKey() const override
+    {
+      return key_;
+    }
+
     A a_;
+    std::string key_;
   };
 
   template <typename A>
@@ -364,6 +463,12 @@ namespace art {
       return expression_.print(indent);
     }
 
+    std::string const&
+    doCacheKey() const override
+    {
+      return expression_.cacheKey();
+    }
+
     wrapped_type expression_;
   };
 
@@ -376,13 +481,17 @@ namespace art {
     template <typename T>
     explicit Selector(T const& expression)
       : sel_{new ComposedSelectorWrapper<T>{expression}}
+      , key_{sel_->cacheKey()}
     {}
 
   private:
     bool doMatch(BranchDescription const& p) const override;
     std::string doPrint(std::string const& indent) const override;
+    std::string const& doCacheKey() const override;
 
     std::shared_ptr<SelectorBase> sel_;
+    // Computed once, as a Selector is typically reused across events.
+    std::string key_;
   };
 
 } // namespace art
@@ -24,6 +24,16 @@
 //
 //   return indent + "Product ID: " << product_id;
 //
+// The 'cacheKey' function may return a string that identifies the
+// selection criteria, in which case the results of 'match' for the
+// products of a given product table are remembered, keyed on that
+// string.  Two selectors with the same key must therefore match the
+// same products.  A selector whose result depends on anything other
+// than the BranchDescription (e.g. a user-provided function) must
+// return an empty string, which is the default.  The key is asked for
+// on each product lookup, so it should be made once, when the
+// selector is constructed.
+//
 // ==========================================================================
 
 #include "art/Framework/Principal/fwd.h"
@@ -49,9 +59,21 @@ public:
     return doPrint(indent);
   }
 
+  std::string const&
+  cacheKey() const
+  {
+    return doCacheKey();
+  }
+
 private:
   virtual bool doMatch(BranchDescription const& p) const = 0;
   virtual std::string doPrint(std::string const& indent) const = 0;
+  virtual std::string const&
+  doCacheKey() const
+  {
+    static std::string const none{};
+    return none;
+  }
 };
 
 #endif /* art_Framework_Principal_SelectorBase_h */
@@ -0,0 +1,62 @@
+#include "art/Framework/Principal/SelectorMatchCache.h"
+// vim: set sw=2 expandtab :
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+using namespace std;
+
+namespace {
+  // Selectors made from event data could otherwise grow the cache
+  // without bound; past this many selectors per list, matches are
+  // simply no longer remembered.
+  constexpr std::size_t max_selectors_per_list{1000};
+}
+
+namespace art {
+
+  SelectorMatchCache*
+  SelectorMatchCache::instance()
+  {
+    static SelectorMatchCache me;
+    return &me;
+  }
+
+  shared_ptr<SelectorMatchCache::Matches const>
+  SelectorMatchCache::find(vector<ProductID> const& list,
+                           string const& key) const
+  {
+    shared_lock sentry{mutex_};
+    auto it = entries_.find(&list);
+    if (it == entries_.cend()) {
+      return nullptr;
+    }
+    auto const& matches = it->second;
+    auto match = matches.find(key);
+    if (match == matches.cend()) {
+      return nullptr;
+    }
+    return match->second;
+  }
+
+  void
+  SelectorMatchCache::insert(vector<ProductID> const& list,
+                             string const& key,
+                             shared_ptr<Matches const> matches)
+  {
+    lock_guard sentry{mutex_};
+    auto& entry = entries_[&list];
+    if (entry.size() < max_selectors_per_list) {
+      entry.insert_or_assign(key, move(matches));
+    }
+  }
+
+  void
+  SelectorMatchCache::invalidate()
+  {
+    lock_guard sentry{mutex_};
+    entries_.clear();
+  }
+
+} // namespace art
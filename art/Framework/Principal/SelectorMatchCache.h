@@ -0,0 +1,68 @@
+#ifndef art_Framework_Principal_SelectorMatchCache_h
+#define art_Framework_Principal_SelectorMatchCache_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// SelectorMatchCache
+//
+// Remembers which products of a product-table lookup list are matched
+// by a selector.  The result of SelectorBase::match depends only on
+// the product description, and not on the event, so it is evaluated
+// once per (lookup list, selector) rather than each time getMany,
+// getView, getProductTokens, etc. are called.
+//
+// Entries are keyed on the address of the lookup list, and then on the
+// cache key of the selector (see SelectorBase::cacheKey).  A lookup
+// list belongs to a product table, which lives at least as long as the
+// input file it describes; as the cache is emptied whenever a new
+// input file is opened, an address is never reused for a different
+// list while it is cached.
+// ====================================================================
+
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace art {
+
+  class SelectorMatchCache {
+  public:
+    SelectorMatchCache(SelectorMatchCache const&) = delete;
+    SelectorMatchCache& operator=(SelectorMatchCache const&) = delete;
+
+    // The matching products, in the order of the lookup list.
+    using Matches = std::vector<ProductID>;
+
+    static SelectorMatchCache* instance();
+
+    std::shared_ptr<Matches const> find(std::vector<ProductID> const& list,
+                                        std::string const& key) const;
+    void insert(std::vector<ProductID> const& list,
+                std::string const& key,
+                std::shared_ptr<Matches const>);
+
+    // Called when the input file changes.
+    void invalidate();
+
+  private:
+    SelectorMatchCache() = default;
+
+    using Entry =
+      std::unordered_map<std::string, std::shared_ptr<Matches const>>;
+
+    // Protects access to entries_.
+    mutable std::shared_mutex mutex_{};
+    std::unordered_map<std::vector<ProductID> const*, Entry> entries_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_SelectorMatchCache_h */
+
+// Local Variables:
+// mode: c++
+// End:
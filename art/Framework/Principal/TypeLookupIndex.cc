@@ -0,0 +1,46 @@
+#include "art/Framework/Principal/TypeLookupIndex.h"
+// vim: set sw=2 expandtab :
+
+#include <mutex>
+
+using namespace std;
+
+namespace art {
+
+  TypeLookupIndex*
+  TypeLookupIndex::instance()
+  {
+    static TypeLookupIndex me;
+    return &me;
+  }
+
+  ProcessLookup const*
+  TypeLookupIndex::find(ProductTable const& table, TypeID const& type)
+  {
+    auto const& lookup = table.productLookup;
+    auto it = lookup.find(friendlyClassName(type));
+    if (it == lookup.cend()) {
+      return nullptr;
+    }
+    return &it->second;
+  }
+
+  string const&
+  TypeLookupIndex::friendlyClassName(TypeID const& type)
+  {
+    type_index const key{type.typeInfo()};
+    {
+      shared_lock sentry{mutex_};
+      if (auto it = names_.find(key); it != names_.cend()) {
+        return it->second;
+      }
+    }
+    // The name is made outside of the lock; if another thread made it
+    // in the meantime, its copy is kept.  Node-based map references
+    // are not invalidated by later insertions.
+    auto name = type.friendlyClassName();
+    lock_guard sentry{mutex_};
+    return names_.try_emplace(key, move(name)).first->second;
+  }
+
+} // namespace art
@@ -0,0 +1,59 @@
+#ifndef art_Framework_Principal_TypeLookupIndex_h
+#define art_Framework_Principal_TypeLookupIndex_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// TypeLookupIndex
+//
+// The product-lookup maps of a product table are keyed on the
+// friendly class name of the product type.  Making that name from a
+// TypeID is costly, and it was done for every lookup.  This index
+// interns the name once per type, keyed on the type itself (its
+// std::type_index), so that a lookup only hashes the interned name.
+//
+// The friendly class name of a type never changes, so the index is
+// never emptied; it holds one entry per product type that has been
+// looked up.
+// ====================================================================
+
+#include "canvas/Persistency/Provenance/ProductTables.h"
+#include "canvas/Persistency/Provenance/type_aliases.h"
+#include "canvas/Utilities/TypeID.h"
+
+#include <shared_mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+namespace art {
+
+  class TypeLookupIndex {
+  public:
+    TypeLookupIndex(TypeLookupIndex const&) = delete;
+    TypeLookupIndex& operator=(TypeLookupIndex const&) = delete;
+
+    static TypeLookupIndex* instance();
+
+    // Returns the per-process lookup of the products of the given
+    // type in the table's product lookup, or null if there are none.
+    ProcessLookup const* find(ProductTable const&, TypeID const&);
+
+    // Returns the friendly class name of the type; the reference
+    // stays valid for the rest of the job.
+    std::string const& friendlyClassName(TypeID const&);
+
+  private:
+    TypeLookupIndex() = default;
+
+    // Protects access to names_.
+    mutable std::shared_mutex mutex_{};
+    std::unordered_map<std::type_index, std::string> names_{};
+  };
+
+} // namespace art
+
+#endif /* art_Framework_Principal_TypeLookupIndex_h */
+
+// Local Variables:
+// mode: c++
+// End:
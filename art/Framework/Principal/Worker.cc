@@ -9,6 +9,7 @@
 #include "art/Framework/Services/Registry/ActivityRegistry.h"
 #include "art/Persistency/Provenance/ModuleContext.h"
 #include "art/Persistency/Provenance/ModuleDescription.h"
+#include "art/Utilities/GlobalTaskGroup.h"
 #include "art/Utilities/TaskDebugMacros.h"
 #include "art/Utilities/Transition.h"
 #include "canvas/Utilities/Exception.h"
@@ -136,6 +137,18 @@ namespace art {
     return returnCode_.load();
   }
 
+  shared_ptr<ProductSlotLayout const> const&
+  Worker::slotLayout() const
+  {
+    return slotLayout_;
+  }
+
+  void
+  Worker::setSlotLayout(shared_ptr<ProductSlotLayout const> layout)
+  {
+    slotLayout_ = move(layout);
+  }
+
   SerialTaskQueueChain*
   Worker::serialTaskQueueChain() const
   {
@@ -475,6 +488,9 @@ namespace art {
       // Note: Only filters ever return false, and when they do it
       // means they have rejected.
       returnCode_ = doProcess(p, mc);
+      if (evictionConsumer_) {
+        p.consumerDone(*evictionConsumer_);
+      }
       actReg_.sPostModule.invoke(mc);
       state_ = Fail;
       if (returnCode_.load()) {
@@ -597,6 +613,29 @@ namespace art {
     return md_.moduleThreadingType() == ModuleThreadingType::replicated;
   }
 
+  class Worker::RunWorkerTask {
+  public:
+    RunWorkerTask(Worker* worker, EventPrincipal& p, ModuleContext const& mc)
+      : worker_{worker}, p_{p}, mc_{mc}
+    {}
+
+    void
+    operator()(exception_ptr)
+    {
+      // Failures to read a product are not reported here, but when
+      // the module retrieves it.
+      auto const sid = mc_.scheduleID();
+      TDEBUG_BEGIN_TASK_SI(4, sid);
+      worker_->startWorker(p_, mc_);
+      TDEBUG_END_TASK_SI(4, sid);
+    }
+
+  private:
+    Worker* worker_;
+    EventPrincipal& p_;
+    ModuleContext const& mc_;
+  };
+
   void
   Worker::doWork_event(WaitingTaskPtr workerInPathDoneTask,
                        EventPrincipal& p,
@@ -618,16 +657,22 @@ namespace art {
     ++counts_visited_;
     bool expected = false;
     if (workStarted_.compare_exchange_strong(expected, true)) {
-      if (auto chain = serialTaskQueueChain()) {
-        // Must be a serialized shared module (including legacy).
-        TDEBUG_FUNC_SI(4, sid) << "pushing onto chain " << hex << chain << dec;
-        chain->push([&p, &mc, this] { runWorker(p, mc); });
+      if (!prefetched_.empty()) {
+        // The module is started once its consumed products have been
+        // read.
+        TDEBUG_FUNC_SI(4, sid) << "prefetching consumed products";
+        auto runWorkerTask = make_waiting_task<RunWorkerTask>(this, p, mc);
+        try {
+          p.prefetchAsync(mc, prefetched_, runWorkerTask, *taskGroup_);
+        }
+        catch (...) {
+          // The module then reads its products itself.
+          taskGroup_->may_run(runWorkerTask);
+        }
         TDEBUG_END_FUNC_SI(4, sid);
         return;
       }
-      // Must be a replicated or shared module with no serialization.
-      TDEBUG_FUNC_SI(4, sid) << "calling worker functor";
-      runWorker(p, mc);
+      startWorker(p, mc);
       TDEBUG_END_FUNC_SI(4, sid);
       return;
     }
@@ -636,4 +681,45 @@ namespace art {
     TDEBUG_END_FUNC_SI(4, sid) << "work already in progress on another path";
   }
 
+  void
+  Worker::startWorker(EventPrincipal& p, ModuleContext const& mc)
+  {
+    auto const sid = mc.scheduleID();
+    if (auto chain = serialTaskQueueChain()) {
+      // Must be a serialized shared module (including legacy).
+      TDEBUG_FUNC_SI(4, sid) << "pushing onto chain " << hex << chain << dec;
+      chain->push([&p, &mc, this] { runWorker(p, mc); });
+      return;
+    }
+    // Must be a replicated or shared module with no serialization.
+    TDEBUG_FUNC_SI(4, sid) << "calling worker functor";
+    runWorker(p, mc);
+  }
+
+  void
+  Worker::prefetchConsumedProducts(
+    ConsumesInfo::SealedConsumables const& consumed,
+    GlobalTaskGroup& taskGroup)
+  {
+    // Only products retrieved by type and input tag can be looked up
+    // before the module is run.
+    prefetched_.clear();
+    auto index = consumed.firstIndex[InEvent];
+    for (auto const& info : (*consumed.consumables)[InEvent]) {
+      auto const this_index = index++;
+      if (info.consumableType != ProductInfo::ConsumableType::Product ||
+          !info.typeID || !info.process.input_source_search_allowed()) {
+        continue;
+      }
+      prefetched_.push_back({this_index, info});
+    }
+    taskGroup_ = &taskGroup;
+  }
+
+  void
+  Worker::evictConsumedProducts(size_t const consumer)
+  {
+    evictionConsumer_ = consumer;
+  }
+
 } // namespace art
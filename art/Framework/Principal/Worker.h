@@ -21,14 +21,22 @@
 // cached and reused until the worker is reset().
 // ======================================================================
 
+#include "art/Framework/Principal/ConsumesInfo.h"
+#include "art/Framework/Principal/ProductInfo.h"
+#include "art/Framework/Principal/ProductTokenCache.h"
 #include "art/Framework/Principal/fwd.h"
 #include "art/Persistency/Provenance/ModuleDescription.h"
+#include "art/Persistency/Provenance/fwd.h"
 #include "art/Utilities/ScheduleID.h"
 #include "art/Utilities/Transition.h"
+#include "art/Utilities/fwd.h"
 #include "hep_concurrency/WaitingTaskList.h"
 
 #include <atomic>
+#include <cstddef>
 #include <exception>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -75,6 +83,9 @@ namespace art {
     bool returnCode() const;
 
     ModuleDescription const& description() const;
+    // The products the module may put, or null if it puts none; passed
+    // to the module through its ModuleContext.
+    std::shared_ptr<ProductSlotLayout const> const& slotLayout() const;
     hep::concurrency::SerialTaskQueueChain* serialTaskQueueChain() const;
 
     // Used by EventProcessor
@@ -92,8 +103,21 @@ namespace art {
     void runWorker(EventPrincipal&, ModuleContext const&);
     bool isUnique() const;
 
+    // Used by PathManager.  The products from the input file that the
+    // module consumes for events are then read, in parallel, before
+    // the module is run.
+    void prefetchConsumedProducts(
+      ConsumesInfo::SealedConsumables const& consumed,
+      GlobalTaskGroup&);
+    // Used by PathManager.  Once the module has run for an event, it
+    // no longer counts as a consumer of its products (see
+    // ProductEviction).
+    void evictConsumedProducts(std::size_t consumer);
+
   protected:
     std::string const& label() const;
+    // Called once the module's products have been registered.
+    void setSlotLayout(std::shared_ptr<ProductSlotLayout const>);
 
     std::atomic<std::size_t> counts_visited_{};
     std::atomic<std::size_t> counts_run_{};
@@ -102,6 +126,10 @@ namespace art {
     std::atomic<std::size_t> counts_thrown_{};
 
   private:
+    class RunWorkerTask;
+
+    void startWorker(EventPrincipal&, ModuleContext const&);
+
     virtual hep::concurrency::SerialTaskQueueChain* doSerialTaskQueueChain()
       const = 0;
     virtual void doBeginJob(detail::SharedResources const& resources) = 0;
@@ -119,6 +147,7 @@ namespace art {
 
     ScheduleID const scheduleID_;
     ModuleDescription const md_;
+    std::shared_ptr<ProductSlotLayout const> slotLayout_{nullptr};
     ActionTable const& actions_;
     ActivityRegistry const& actReg_;
     std::atomic<int> state_{Ready};
@@ -141,6 +170,12 @@ namespace art {
     // schedule has its own private worker copies (the whole reason
     // schedules exist!).
     hep::concurrency::WaitingTaskList waitingTasks_;
+    // The consumed products to read before the module is run, if
+    // requested.
+    std::vector<ProductTokenCache::Consumed> prefetched_{};
+    GlobalTaskGroup* taskGroup_{nullptr};
+    // The consumer index of the module, if products are evicted early.
+    std::optional<std::size_t> evictionConsumer_{};
   };
 
 } // namespace art
@@ -20,6 +20,7 @@
 #endif
 
 #include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/ProductEviction.h"
 #include "art/Framework/Services/Optional/detail/LinuxMallInfo.h"
 #include "art/Framework/Services/Registry/ActivityRegistry.h"
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
@@ -446,6 +447,10 @@ namespace art {
           << " MB\n"
           << "  Peak resident set size usage (VmHWM): " << unique_value(rRMax)
           << " MB\n";
+      if (auto const evictions = ProductEviction::instance()->evictions()) {
+        log << "  Event products evicted early       : " << evictions
+            << '\n';
+      }
       if (using_file_database_()) {
         log << "  Details saved in: '" << fileName_ << "'\n";
       }
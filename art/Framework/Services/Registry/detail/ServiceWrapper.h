@@ -82,8 +82,8 @@ namespace art {
       {
         if constexpr (std::is_base_of_v<ProducingService, T>) {
           service_ptr_->registerCallbacks(signals);
-          service_ptr_->setModuleDescription(md);
           service_ptr_->registerProducts(productsToProduce, md);
+          service_ptr_->setModuleDescription(md);
         }
       }
 
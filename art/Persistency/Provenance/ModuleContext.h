@@ -3,20 +3,29 @@
 
 #include "art/Persistency/Provenance/ModuleDescription.h"
 #include "art/Persistency/Provenance/PathContext.h"
+#include "art/Persistency/Provenance/ProductSlotLayout.h"
+
+#include <memory>
 
 namespace art {
   class ModuleContext {
     explicit ModuleContext() = default;
 
   public:
-    explicit ModuleContext(PathContext const& pathContext,
-                           ModuleDescription const& md)
-      : pathContext_{pathContext}, md_{md}
+    explicit ModuleContext(
+      PathContext const& pathContext,
+      ModuleDescription const& md,
+      std::shared_ptr<ProductSlotLayout const> slotLayout = nullptr)
+      : pathContext_{pathContext}, md_{md}, slotLayout_{std::move(slotLayout)}
     {}
 
     // This constructor is used in cases where the path context is
     // unneeded.
-    explicit ModuleContext(ModuleDescription const& md) : md_{md} {}
+    explicit ModuleContext(
+      ModuleDescription const& md,
+      std::shared_ptr<ProductSlotLayout const> slotLayout = nullptr)
+      : md_{md}, slotLayout_{std::move(slotLayout)}
+    {}
 
     static ModuleContext
     invalid()
@@ -65,10 +74,18 @@ namespace art {
     {
       return pathContext_.contains(module_label);
     }
+    // The products the module may put, or null if the context was not
+    // made for a module whose products were registered.
+    auto const&
+    slotLayout() const
+    {
+      return slotLayout_;
+    }
 
   private:
     PathContext pathContext_{PathContext::invalid()};
     ModuleDescription md_{};
+    std::shared_ptr<ProductSlotLayout const> slotLayout_{};
   };
 }
 
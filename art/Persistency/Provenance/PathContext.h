@@ -34,6 +34,20 @@ namespace art {
       return PathSpec{art_path(), PathID::invalid()};
     }
 
+    // The context of the producers that are run on demand, which do
+    // not belong to any path.
+    static std::string
+    on_demand_path()
+    {
+      return "[on_demand]";
+    }
+
+    static auto
+    on_demand_path_spec()
+    {
+      return PathSpec{on_demand_path(), PathID::invalid()};
+    }
+
     explicit PathContext(ScheduleContext const& scheduleContext,
                          PathSpec const& pathSpec,
                          std::vector<std::string> sortedModuleNames)
@@ -0,0 +1,35 @@
+#include "art/Persistency/Provenance/ProductSlotLayout.h"
+// vim: set sw=2 expandtab :
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+namespace art {
+
+  ProductSlotLayout::ProductSlotLayout(vector<BranchDescription> products)
+  {
+    sort(products.begin(), products.end(), [](auto const& a, auto const& b) {
+      return a.productID() < b.productID();
+    });
+    for (auto& pd : products) {
+      auto const bt = pd.branchType();
+      pids_[bt].push_back(pd.productID());
+      descriptions_[bt].push_back(move(pd));
+    }
+  }
+
+  vector<ProductID> const&
+  ProductSlotLayout::pids(BranchType const bt) const
+  {
+    return pids_[bt];
+  }
+
+  vector<BranchDescription> const&
+  ProductSlotLayout::descriptions(BranchType const bt) const
+  {
+    return descriptions_[bt];
+  }
+
+} // namespace art
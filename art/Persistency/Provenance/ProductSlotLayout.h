@@ -0,0 +1,44 @@
+#ifndef art_Persistency_Provenance_ProductSlotLayout_h
+#define art_Persistency_Provenance_ProductSlotLayout_h
+// vim: set sw=2 expandtab :
+
+// ====================================================================
+// ProductSlotLayout
+//
+// The products that a module may put, for each branch type, in
+// ProductID order.  The layout is made once, when the products of the
+// module are registered, and reaches the ProductInserters made for
+// the module through its ModuleContext.  A product put by the module
+// is stored in the slot of its position in the layout.
+// ====================================================================
+
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/BranchType.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+#include <array>
+#include <vector>
+
+namespace art {
+
+  class ProductSlotLayout {
+  public:
+    // The products of the module, of any branch type and in any order.
+    explicit ProductSlotLayout(std::vector<BranchDescription> products);
+
+    std::vector<ProductID> const& pids(BranchType) const;
+    std::vector<BranchDescription> const& descriptions(BranchType) const;
+
+  private:
+    std::array<std::vector<ProductID>, NumBranchTypes> pids_{};
+    std::array<std::vector<BranchDescription>, NumBranchTypes>
+      descriptions_{};
+  };
+
+} // namespace art
+
+#endif /* art_Persistency_Provenance_ProductSlotLayout_h */
+
+// Local Variables:
+// mode: c++
+// End:
@@ -9,6 +9,7 @@ namespace art {
   class ModuleContext;
   class ModuleDescription;
   class PathContext;
+  class ProductSlotLayout;
 } // namespace art
 
 // ======================================================================
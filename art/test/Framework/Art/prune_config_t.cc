@@ -247,4 +247,68 @@ BOOST_AUTO_TEST_CASE(unsupported_physics_parameters)
     "---- Configuration END\n"};
   check_exception(config, err_msg);
 }
+
+BOOST_AUTO_TEST_CASE(on_demand_filter)
+{
+  std::string const config{"process_name: \"test\" "
+                           "physics: { "
+                           "  filters: { "
+                           "    f: { module_type: PMTestFilter } "
+                           "  } "
+                           " on_demand: [ f ] "
+                           "}"};
+  std::string const err_msg{"---- Configuration BEGIN\n"
+                            "  The following error occurred while "
+                            "processing the 'on_demand' sequence:\n"
+                            "  Entry with name f cannot be run on demand.\n"
+                            "  Only producers, without a '!' or '-' prefix, "
+                            "can be run on demand.\n"
+                            "---- Configuration END\n"};
+  check_exception(config, err_msg);
+}
+
+BOOST_AUTO_TEST_CASE(on_demand_producer_on_path)
+{
+  std::string const config{"process_name: \"test\" "
+                           "physics: { "
+                           "  producers: { "
+                           "    p: { module_type: PMTestProducer } "
+                           "  } "
+                           " p1: [ p ] "
+                           " on_demand: [ p ] "
+                           "}"};
+  std::string const err_msg{
+    "---- Configuration BEGIN\n"
+    "  The following error occurred while processing the 'on_demand' "
+    "sequence:\n"
+    "  The producer p is also assigned to an enabled path.\n"
+    "  A producer can be run either on demand or on paths, but not both.\n"
+    "---- Configuration END\n"};
+  check_exception(config, err_msg);
+}
+
+BOOST_AUTO_TEST_CASE(on_demand_producer)
+{
+  // The 'on_demand' sequence is not a path.
+  std::string const config{"process_name: \"test\" "
+                           "physics: { "
+                           "  producers: { "
+                           "    p: { module_type: PMTestProducer } "
+                           "    q: { module_type: PMTestProducer } "
+                           "  } "
+                           " p1: [ p ] "
+                           " on_demand: [ q ] "
+                           "}"};
+  auto raw_config = fhicl::parse_document(config);
+  auto const enabled_modules =
+    detail::prune_config_if_enabled(false, true, raw_config);
+  auto const& trigger_paths = enabled_modules.trigger_path_specs();
+  BOOST_TEST_REQUIRE(trigger_paths.size() == 1ull);
+  BOOST_TEST(trigger_paths[0].first.name == "p1");
+  BOOST_TEST(enabled_modules.on_demand_modules() ==
+               std::vector<std::string>{"q"},
+             boost::test_tools::per_element{});
+  BOOST_TEST(enabled_modules.modules().count("q") == 1ull);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,64 @@
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "art/Utilities/OutputFileInfo.h"
+#include "fhiclcpp/fwd.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+
+// Checks that the closure of each output file is announced on the
+// main thread, after the file has been closed and once it can be found
+// under its final name.
+
+namespace arttest {
+  class CloseOutputFileChecker {
+  public:
+    CloseOutputFileChecker(fhicl::ParameterSet const&,
+                           art::ActivityRegistry& reg)
+    {
+      reg.sPreCloseOutputFile.watch(this,
+                                    &CloseOutputFileChecker::preClose);
+      reg.sPostCloseOutputFile.watch(this,
+                                     &CloseOutputFileChecker::postClose);
+      reg.sPostEndJob.watch(this, &CloseOutputFileChecker::postEndJob);
+    }
+
+  private:
+    void
+    preClose(std::string const& label)
+    {
+      BOOST_TEST((std::this_thread::get_id() == mainThread_));
+      ++closing_[label];
+    }
+
+    void
+    postClose(art::OutputFileInfo const& info)
+    {
+      BOOST_TEST((std::this_thread::get_id() == mainThread_));
+      auto& n = closed_[info.moduleLabel()];
+      BOOST_TEST(n < closing_[info.moduleLabel()]);
+      ++n;
+      if (!info.fileName().empty()) {
+        BOOST_TEST(std::ifstream{info.fileName()}.good());
+      }
+    }
+
+    void
+    postEndJob()
+    {
+      BOOST_TEST((closed_ == closing_));
+    }
+
+    std::thread::id const mainThread_{std::this_thread::get_id()};
+    std::map<std::string, unsigned> closing_{};
+    std::map<std::string, unsigned> closed_{};
+  };
+}
+
+DECLARE_ART_SERVICE(arttest::CloseOutputFileChecker, SHARED)
+DEFINE_ART_SERVICE(arttest::CloseOutputFileChecker)
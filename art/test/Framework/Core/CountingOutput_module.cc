@@ -0,0 +1,217 @@
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Core/OutputModule.h"
+#include "art/Framework/IO/ClosingCriteria.h"
+#include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/fwd.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/ConfigurationTable.h"
+#include "fhiclcpp/types/Table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts the events written to each of its (notional) output files,
+// which it closes according to its 'fileProperties' table, as a ROOT
+// output module would.  Checks that each file has been closed in
+// time, that every event has been written, and that the events have
+// been handed over in batches of the configured size.
+//
+// If asked to finish its files in the background, the module writes
+// the IDs of the events of each file to a temporary file.  The
+// function returned by detachEndFile then writes the number of events,
+// and renames the file to its final name.
+
+namespace {
+  class CountingOutput : public art::OutputModule {
+  public:
+    struct Config {
+      fhicl::TableFragment<art::OutputModule::Config> omConfig;
+      fhicl::Table<art::ClosingCriteria::Config> fileProperties{
+        fhicl::Name{"fileProperties"}};
+      fhicl::Atom<unsigned> maxExtraEvents{
+        fhicl::Name{"maxExtraEvents"},
+        fhicl::Comment{
+          "The number of events that a file may receive beyond\n"
+          "'fileProperties.maxEvents' before it is closed."},
+        0u};
+      fhicl::Atom<unsigned> expected{fhicl::Name{"expected"}};
+      fhicl::Atom<unsigned> writeMicroseconds{
+        fhicl::Name{"writeMicroseconds"},
+        fhicl::Comment{"The time taken by each call to 'writeBatch'."},
+        0u};
+      fhicl::Atom<std::size_t> minLargestBatch{
+        fhicl::Name{"minLargestBatch"},
+        fhicl::Comment{
+          "The size that the largest batch of events must at least reach."},
+        1u};
+      fhicl::Atom<bool> finishFilesInBackground{
+        fhicl::Name{"finishFilesInBackground"},
+        false};
+      fhicl::Atom<int> failingFile{
+        fhicl::Name{"failingFile"},
+        fhicl::Comment{
+          "The index of the file that cannot be finished, or -1 for none."},
+        -1};
+    };
+    using Parameters =
+      fhicl::WrappedTable<Config, art::OutputModule::Config::KeysToIgnore>;
+    explicit CountingOutput(Parameters const& p)
+      : OutputModule{p().omConfig}
+      , closingCriteria_{p().fileProperties()}
+      , maxEventsInFile_{closingCriteria_.fileProperties().nEvents() +
+                         p().maxExtraEvents()}
+      , expected_{p().expected()}
+      , writeTime_{p().writeMicroseconds()}
+      , maxBatchSize_{
+          std::max(p().omConfig().writeBatchSize(), std::size_t{1})}
+      , minLargestBatch_{p().minLargestBatch()}
+      , fileName_{p().omConfig().fileName()}
+      , finishInBackground_{p().finishFilesInBackground()}
+      , failingFile_{p().failingFile()}
+    {}
+
+  private:
+    void
+    write(art::EventPrincipal& ep) override
+    {
+      BOOST_TEST_REQUIRE(fileOpen_);
+      fileProperties_.update_event();
+      if (file_) {
+        *file_ << ep.eventID() << '\n';
+      }
+    }
+
+    void
+    writeBatch(std::vector<art::EventPrincipal*> const& events) override
+    {
+      batchSizes_.push_back(events.size());
+      std::this_thread::sleep_for(writeTime_);
+      for (auto ep : events) {
+        write(*ep);
+      }
+    }
+
+    void
+    writeSubRun(art::SubRunPrincipal&) override
+    {}
+
+    void
+    writeRun(art::RunPrincipal&) override
+    {}
+
+    bool
+    isFileOpen() const override
+    {
+      return fileOpen_;
+    }
+
+    void
+    openFile(art::FileBlock const&) override
+    {
+      fileProperties_ = art::FileProperties{};
+      fileOpen_ = true;
+      if (finishInBackground_) {
+        file_ = std::make_shared<std::ofstream>(
+          fileName(eventsPerFile_.size()) + ".tmp");
+      }
+    }
+
+    bool
+    requestsToCloseFile() const override
+    {
+      return closingCriteria_.should_close(fileProperties_);
+    }
+
+    art::Granularity
+    fileGranularity() const override
+    {
+      return closingCriteria_.granularity();
+    }
+
+    void
+    startEndFile() override
+    {
+      eventsPerFile_.push_back(fileProperties_.nEvents());
+      fileOpen_ = false;
+    }
+
+    EndFileFunction
+    detachEndFile() override
+    {
+      if (!finishInBackground_) {
+        return {};
+      }
+      auto const index = eventsPerFile_.size() - 1;
+      return [file = std::move(file_),
+              name = fileName(index),
+              nEvents = eventsPerFile_.back(),
+              fail = failingFile_ == static_cast<int>(index)](
+               auto const& /*md*/, auto const& /*ssmd*/) {
+        *file << "events: " << nEvents << '\n';
+        file->close();
+        auto const tmpName = name + ".tmp";
+        if (fail || std::rename(tmpName.c_str(), name.c_str()) != 0) {
+          throw cet::exception("CountingOutput")
+            << "Failed to finish file " << name << ".\n";
+        }
+        return name;
+      };
+    }
+
+    std::string
+    fileName(std::size_t const index) const
+    {
+      return fileName_ + '_' + std::to_string(index) + ".txt";
+    }
+
+    void
+    endJob() override
+    {
+      auto const maxEvents = closingCriteria_.fileProperties().nEvents();
+      unsigned total{};
+      for (std::size_t i = 0; i != eventsPerFile_.size(); ++i) {
+        auto const n = eventsPerFile_[i];
+        // The last file is closed by the end of the job.
+        if (i + 1 != eventsPerFile_.size()) {
+          BOOST_TEST(n >= maxEvents);
+        }
+        BOOST_TEST(n <= maxEventsInFile_);
+        total += n;
+      }
+      BOOST_TEST(total == expected_);
+
+      // A single event is handed to write rather than to writeBatch.
+      std::size_t largestBatch{1};
+      for (auto const n : batchSizes_) {
+        largestBatch = std::max(largestBatch, n);
+      }
+      BOOST_TEST(largestBatch <= maxBatchSize_);
+      BOOST_TEST(largestBatch >= minLargestBatch_);
+    }
+
+    art::ClosingCriteria const closingCriteria_;
+    unsigned const maxEventsInFile_;
+    unsigned const expected_;
+    std::chrono::microseconds const writeTime_;
+    std::size_t const maxBatchSize_;
+    std::size_t const minLargestBatch_;
+    std::string const fileName_;
+    bool const finishInBackground_;
+    int const failingFile_;
+    art::FileProperties fileProperties_{};
+    bool fileOpen_{false};
+    std::vector<unsigned> eventsPerFile_{};
+    std::vector<std::size_t> batchSizes_{};
+    std::shared_ptr<std::ofstream> file_{nullptr};
+  };
+}
+
+DEFINE_ART_MODULE(CountingOutput)
@@ -0,0 +1,101 @@
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Core/SharedProducer.h"
+#include "art/Framework/Principal/Event.h"
+#include "canvas/Persistency/Provenance/EventID.h"
+#include "canvas/Utilities/InputTag.h"
+#include "fhiclcpp/types/Atom.h"
+#include "fhiclcpp/types/Sequence.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+  // The number of DependentProducer modules running for each event,
+  // and whether two of them have ever run at the same time for the
+  // same event.
+  std::mutex running_mutex;
+  std::map<art::EventID, unsigned> running;
+  std::atomic<bool> overlap_seen{false};
+
+  // Produces an int, after checking that the ints produced by the
+  // modules it consumes from are available.
+  class DependentProducer : public art::SharedProducer {
+  public:
+    struct Config {
+      fhicl::Sequence<art::InputTag> inputs{fhicl::Name{"inputs"}, {}};
+      fhicl::Atom<unsigned> expected{
+        fhicl::Name{"expected"},
+        fhicl::Comment{
+          "The number of events for which the module is expected to run."}};
+      fhicl::Atom<unsigned> sleepMilliseconds{fhicl::Name{"sleepMilliseconds"},
+                                              0u};
+      fhicl::Atom<bool> expectOverlap{
+        fhicl::Name{"expectOverlap"},
+        fhicl::Comment{
+          "If true, two DependentProducer modules are expected to have run\n"
+          "at the same time for the same event at least once."},
+        false};
+    };
+    using Parameters = Table<Config>;
+    explicit DependentProducer(Parameters const& p,
+                               art::ProcessingFrame const&)
+      : SharedProducer{p}
+      , expected_{p().expected()}
+      , sleep_{p().sleepMilliseconds()}
+      , expectOverlap_{p().expectOverlap()}
+    {
+      for (auto const& tag : p().inputs()) {
+        tokens_.push_back(consumes<int>(tag));
+      }
+      produces<int>();
+      async<art::InEvent>();
+    }
+
+  private:
+    void
+    produce(art::Event& e, art::ProcessingFrame const&) override
+    {
+      for (auto const& token : tokens_) {
+        BOOST_TEST(*e.getValidHandle(token) == 1);
+      }
+      {
+        std::lock_guard sentry{running_mutex};
+        if (running[e.id()]++ != 0u) {
+          overlap_seen = true;
+        }
+      }
+      std::this_thread::sleep_for(sleep_);
+      {
+        std::lock_guard sentry{running_mutex};
+        if (--running[e.id()] == 0u) {
+          running.erase(e.id());
+        }
+      }
+      e.put(std::make_unique<int>(1));
+      ++n_;
+    }
+
+    void
+    endJob(art::ProcessingFrame const&) override
+    {
+      BOOST_TEST(n_ == expected_);
+      if (expectOverlap_) {
+        BOOST_TEST(overlap_seen.load());
+      }
+    }
+
+    std::vector<art::ProductToken<int>> tokens_{};
+    unsigned const expected_;
+    std::chrono::milliseconds const sleep_;
+    bool const expectOverlap_;
+    std::atomic<unsigned> n_{};
+  };
+}
+
+DEFINE_ART_MODULE(DependentProducer)
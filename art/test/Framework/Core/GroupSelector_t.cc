@@ -70,6 +70,17 @@ namespace {
     }
 
     BOOST_TEST_REQUIRE(expected == results, boost::test_tools::per_element{});
+
+    // Applying the rules again must give the same (now remembered)
+    // selections.
+    results.clear();
+    for (std::size_t i{}; i < art::NumBranchTypes; ++i) {
+      auto const bt = static_cast<art::BranchType>(i);
+      auto const& descriptions = pTables.descriptions(bt);
+      art::GroupSelector const gs{gsr, descriptions};
+      apply_gs(gs, descriptions, results);
+    }
+    BOOST_TEST_REQUIRE(expected == results, boost::test_tools::per_element{});
   }
 
   class GlobalSetup {
@@ -0,0 +1,55 @@
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Core/ReplicatedAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/SubRun.h"
+#include "canvas/Persistency/Provenance/SubRunID.h"
+#include "fhiclcpp/ParameterSet.h"
+
+// Checks that each instance of a replicated module sees its subrun
+// transitions in order, and only sees events belonging to the subrun
+// it was most recently told about.
+
+namespace {
+  class SubRunSequence : public art::ReplicatedAnalyzer {
+  public:
+    explicit SubRunSequence(fhicl::ParameterSet const& ps,
+                            art::ProcessingFrame const& frame)
+      : ReplicatedAnalyzer{ps, frame}
+    {}
+
+  private:
+    void
+    beginSubRun(art::SubRun const& sr, art::ProcessingFrame const&) override
+    {
+      BOOST_TEST(!current_.isValid());
+      BOOST_TEST((!previous_.isValid() || previous_ < sr.id()));
+      current_ = sr.id();
+    }
+
+    void
+    analyze(art::Event const& e, art::ProcessingFrame const&) override
+    {
+      BOOST_TEST(e.subRunID() == current_);
+    }
+
+    void
+    endSubRun(art::SubRun const& sr, art::ProcessingFrame const&) override
+    {
+      BOOST_TEST(sr.id() == current_);
+      previous_ = current_;
+      current_ = art::SubRunID{};
+    }
+
+    void
+    endJob(art::ProcessingFrame const&) override
+    {
+      BOOST_TEST(!current_.isValid());
+    }
+
+    art::SubRunID current_{};
+    art::SubRunID previous_{};
+  };
+}
+
+DEFINE_ART_MODULE(SubRunSequence)
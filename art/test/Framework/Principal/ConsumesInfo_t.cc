@@ -0,0 +1,141 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (ConsumesInfo_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/ConsumesInfo.h"
+#include "art/Framework/Principal/ProcessTag.h"
+#include "art/Framework/Principal/ProductInfo.h"
+#include "art/Persistency/Provenance/ModuleDescription.h"
+#include "art/Persistency/Provenance/ModuleType.h"
+#include "canvas/Persistency/Provenance/ProcessConfiguration.h"
+#include "canvas/Utilities/Exception.h"
+#include "canvas/Utilities/TypeID.h"
+#include "fhiclcpp/ParameterSetID.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace art;
+
+namespace {
+  ProductInfo
+  declared(std::string const& label)
+  {
+    return ProductInfo{ProductInfo::ConsumableType::Product,
+                       TypeID{typeid(int)},
+                       label,
+                       "",
+                       ProcessTag{"", "CURRENT"}};
+  }
+
+  ModuleDescription
+  module(std::string const& label)
+  {
+    return ModuleDescription{fhicl::ParameterSetID{},
+                             "Consumer",
+                             label,
+                             ModuleThreadingType::shared,
+                             ProcessConfiguration{"CURRENT", {}, {}}};
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(ConsumesInfo_t)
+
+BOOST_AUTO_TEST_CASE(sealed_indices)
+{
+  auto consumes = ConsumesInfo::instance();
+  ConsumesInfo::consumables_t::mapped_type a;
+  a[InEvent] = {declared("x"), declared("y")};
+  std::sort(begin(a[InEvent]), end(a[InEvent]));
+  a[InRun] = {declared("r")};
+  consumes->collectConsumes("a", a);
+  ConsumesInfo::consumables_t::mapped_type b;
+  b[InEvent] = {declared("x")};
+  consumes->collectConsumes("b", b);
+
+  // Nothing is indexed before the information is sealed.
+  BOOST_TEST(consumes->sealedConsumables("a") == nullptr);
+  BOOST_TEST(consumes->numConsumables() == 0u);
+  BOOST_TEST(!consumes->validateConsumedProduct(
+    InEvent, module("a"), declared("x")));
+
+  consumes->sealConsumes();
+  BOOST_TEST_REQUIRE(consumes->numConsumables() == 4u);
+
+  // Every consumes statement of every module has its own index.
+  std::set<std::size_t> indices;
+  for (auto const& [label, md] : {std::pair{"a", module("a")},
+                                  std::pair{"b", module("b")}}) {
+    auto const sealed = consumes->sealedConsumables(label);
+    BOOST_TEST_REQUIRE(sealed != nullptr);
+    BOOST_TEST(sealed->consumables == &consumes->consumables(label));
+    for (std::size_t bt{}; bt != NumBranchTypes; ++bt) {
+      auto const branch_type = static_cast<BranchType>(bt);
+      auto const& infos = (*sealed->consumables)[bt];
+      for (std::size_t i{}; i != infos.size(); ++i) {
+        auto const index =
+          consumes->validateConsumedProduct(branch_type, md, infos[i]);
+        BOOST_TEST_REQUIRE(index.has_value());
+        BOOST_TEST(*index == sealed->firstIndex[bt] + i);
+        BOOST_TEST((consumes->validateConsumedProduct(
+                      branch_type, md, infos[i], sealed) == index));
+        indices.insert(*index);
+      }
+    }
+  }
+  BOOST_TEST(indices == (std::set<std::size_t>{0, 1, 2, 3}));
+
+  // A module without consumes statements consumes nothing.
+  auto const none = consumes->sealedConsumables("c");
+  BOOST_TEST_REQUIRE(none != nullptr);
+  for (auto const& infos : *none->consumables) {
+    BOOST_TEST(infos.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(missing_consumes)
+{
+  auto consumes = ConsumesInfo::instance();
+  auto const md = module("a");
+
+  // A product consumed for another branch type is not declared.
+  BOOST_TEST(!consumes->validateConsumedProduct(InEvent, md, declared("r")));
+
+  // Each thread records its missing statements into its own buffer;
+  // they are all merged.
+  std::vector<std::thread> threads;
+  for (int i{}; i != 4; ++i) {
+    threads.emplace_back([consumes, &md, i] {
+      for (int n{}; n != 100; ++n) {
+        (void)consumes->validateConsumedProduct(
+          InEvent, md, declared("z" + std::to_string(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto const missing = consumes->missingConsumes();
+  BOOST_TEST_REQUIRE(missing.count("a") == 1u);
+  std::set<std::string> labels;
+  for (auto const& info : missing.at("a")[InEvent]) {
+    labels.insert(info.label);
+  }
+  std::set<std::string> const expected{"r", "z0", "z1", "z2", "z3"};
+  BOOST_TEST(missing.at("a")[InEvent].size() == expected.size());
+  BOOST_TEST(labels == expected);
+  BOOST_TEST(missing.at("a")[InRun].empty());
+  BOOST_TEST(missing.count("b") == 0u);
+
+  // When consumes statements are required, a missing one is an error.
+  consumes->setRequireConsumes(true);
+  BOOST_CHECK_THROW(
+    consumes->validateConsumedProduct(InEvent, md, declared("w")),
+    art::Exception);
+  consumes->setRequireConsumes(false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,384 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (DelayedReader_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/ConsumesInfo.h"
+#include "art/Framework/Principal/DelayedReader.h"
+#include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/Group.h"
+#include "art/Framework/Principal/ProcessTag.h"
+#include "art/Framework/Principal/ProductInfo.h"
+#include "art/Framework/Principal/ProductTokenCache.h"
+#include "art/Framework/Principal/SecondaryFileIndex.h"
+#include "art/Framework/Principal/Selector.h"
+#include "art/Persistency/Provenance/ModuleContext.h"
+#include "art/Persistency/Provenance/ModuleDescription.h"
+#include "art/Persistency/Provenance/ModuleType.h"
+#include "art/Persistency/Provenance/ProcessHistoryRegistry.h"
+#include "art/Utilities/GlobalTaskGroup.h"
+#include "art/test/TestObjects/ToyProducts.h"
+#include "canvas/Persistency/Common/WrappedTypeID.h"
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/EventAuxiliary.h"
+#include "canvas/Persistency/Provenance/ProcessConfiguration.h"
+#include "canvas/Persistency/Provenance/ProcessHistory.h"
+#include "canvas/Persistency/Provenance/ProductProvenance.h"
+#include "canvas/Persistency/Provenance/ProductStatus.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
+#include "canvas/Persistency/Provenance/Timestamp.h"
+#include "canvas/Persistency/Provenance/TypeLabel.h"
+#include "canvas/Utilities/InputTag.h"
+#include "canvas/Utilities/TypeID.h"
+#include "fhiclcpp/ParameterSetID.h"
+#include "hep_concurrency/WaitingTask.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace art;
+using namespace hep::concurrency;
+using namespace std::string_literals;
+
+namespace {
+  ProcessConfiguration const early{"EARLY", {}, {}};
+  ProcessConfiguration const current{"CURRENT", {}, {}};
+
+  // Products of the input file, one per module label.
+  BranchDescription
+  present_description(std::string const& label)
+  {
+    TypeLabel const type_label{
+      TypeID{typeid(arttest::IntProduct)}, "", false, label};
+    return BranchDescription{
+      InEvent, type_label, label, fhicl::ParameterSetID{}, early};
+  }
+
+  // Reads each product only after a short delay, as a reader of a
+  // real file would, counting the reads.
+  class StubReader : public DelayedReader {
+  public:
+    explicit StubReader(std::vector<ProductID> pids) : pids_{std::move(pids)}
+    {}
+
+    unsigned
+    reads() const
+    {
+      return reads_.load();
+    }
+
+  private:
+    std::unique_ptr<EDProduct>
+    getProduct_(Group const*, ProductID const pid, RangeSet&) const override
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      ++reads_;
+      return std::make_unique<Wrapper<arttest::IntProduct>>(
+        std::make_unique<arttest::IntProduct>(pid.value()));
+    }
+
+    std::vector<ProductProvenance>
+    readProvenance_() const override
+    {
+      std::vector<ProductProvenance> result;
+      for (auto const pid : pids_) {
+        result.emplace_back(pid, productstatus::present());
+      }
+      return result;
+    }
+
+    std::vector<ProductID> pids_;
+    mutable std::atomic<unsigned> reads_{};
+  };
+
+  // Reads the event from the first secondary file, at or after the
+  // given index, that holds it, counting the reads of each file.  A
+  // file is represented by the table of its products, or by null if
+  // it does not hold the event.
+  class SecondaryFileReader : public StubReader {
+  public:
+    SecondaryFileReader(EventAuxiliary const& aux,
+                        std::vector<ProductTables const*> files,
+                        std::vector<unsigned>& reads)
+      : StubReader{{}}, aux_{aux}, files_{std::move(files)}, reads_{reads}
+    {}
+
+  private:
+    std::unique_ptr<Principal>
+    readFromSecondaryFile_(int& idx) override
+    {
+      while (static_cast<std::size_t>(idx) < files_.size()) {
+        auto const file = idx++;
+        if (files_[file] == nullptr) {
+          continue;
+        }
+        ++reads_[file];
+        auto const& table = files_[file]->get(InEvent);
+        std::vector<ProductID> pids;
+        for (auto const& pr : table.descriptions) {
+          pids.push_back(pr.first);
+        }
+        return std::make_unique<EventPrincipal>(
+          aux_, current, &table, std::make_unique<StubReader>(pids));
+      }
+      return nullptr;
+    }
+
+    EventAuxiliary const aux_;
+    std::vector<ProductTables const*> const files_;
+    std::vector<unsigned>& reads_;
+  };
+
+  // Reads the provenance of the products, with the given status each,
+  // counting the reads.
+  class ProvenanceReader : public DelayedReader {
+  public:
+    ProvenanceReader(std::map<ProductID, ProductStatus> statuses,
+                     bool const concurrent,
+                     unsigned& reads)
+      : statuses_{std::move(statuses)}, concurrent_{concurrent}, reads_{reads}
+    {}
+
+  private:
+    std::unique_ptr<EDProduct>
+    getProduct_(Group const*, ProductID, RangeSet&) const override
+    {
+      return nullptr;
+    }
+
+    std::vector<ProductProvenance>
+    readProvenance_() const override
+    {
+      ++reads_;
+      std::vector<ProductProvenance> result;
+      for (auto const& [pid, status] : statuses_) {
+        result.emplace_back(pid, status);
+      }
+      return result;
+    }
+
+    bool
+    readsProvenanceConcurrently_() const override
+    {
+      return concurrent_;
+    }
+
+    std::map<ProductID, ProductStatus> const statuses_;
+    bool const concurrent_;
+    unsigned& reads_;
+  };
+
+  struct ReaderFixture {
+    ReaderFixture();
+
+    std::unique_ptr<EventPrincipal> make_principal();
+
+    std::map<std::string, ProductID> pids_;
+    ProductTables presentProducts_{ProductTables::invalid()};
+    ProcessHistoryID processHistoryID_;
+    StubReader* reader_{nullptr};
+  };
+
+  ReaderFixture::ReaderFixture()
+  {
+    ProductDescriptions descriptions;
+    for (auto const& label : {"a"s, "b"s, "c"s}) {
+      auto const& pd = descriptions.emplace_back(present_description(label));
+      pids_.emplace(label, pd.productID());
+    }
+    presentProducts_ = ProductTables{descriptions};
+
+    ProcessHistory history;
+    history.push_back(early);
+    processHistoryID_ = history.id();
+    ProcessHistoryRegistry::emplace(processHistoryID_, history);
+  }
+
+  std::unique_ptr<EventPrincipal>
+  ReaderFixture::make_principal()
+  {
+    EventAuxiliary aux{EventID{1, 1, 1}, Timestamp{1234567UL}, true};
+    aux.setProcessHistoryID(processHistoryID_);
+    std::vector<ProductID> pids;
+    for (auto const& pr : pids_) {
+      pids.push_back(pr.second);
+    }
+    auto reader = std::make_unique<StubReader>(std::move(pids));
+    reader_ = reader.get();
+    return std::make_unique<EventPrincipal>(
+      aux, current, &presentProducts_.get(InEvent), std::move(reader));
+  }
+
+  ProductInfo
+  consumed(std::string const& label)
+  {
+    return ProductInfo{ProductInfo::ConsumableType::Product,
+                       TypeID{typeid(arttest::IntProduct)},
+                       label,
+                       "",
+                       ProcessTag{"", current.processName()}};
+  }
+
+  // Stands in for the module, which is run once its consumed products
+  // have been prefetched (see Worker::doWork_event).
+  class ModuleBodyTask {
+  public:
+    ModuleBodyTask(StubReader const& reader, unsigned& readsBeforeBody)
+      : reader_{reader}, readsBeforeBody_{readsBeforeBody}
+    {}
+
+    void
+    operator()(std::exception_ptr)
+    {
+      readsBeforeBody_ = reader_.reads();
+    }
+
+  private:
+    StubReader const& reader_;
+    unsigned& readsBeforeBody_;
+  };
+}
+
+BOOST_FIXTURE_TEST_SUITE(DelayedReader_t, ReaderFixture)
+
+BOOST_AUTO_TEST_CASE(consumed_products_read_before_module)
+{
+  // The module consumes two of the three products of the input file.
+  std::string const label{"consumer"};
+  ConsumesInfo::consumables_t::mapped_type consumables;
+  consumables[InEvent] = {consumed("a"), consumed("b")};
+  std::sort(begin(consumables[InEvent]), end(consumables[InEvent]));
+  auto consumes = ConsumesInfo::instance();
+  consumes->collectConsumes(label, consumables);
+  consumes->sealConsumes();
+  auto const sealed = consumes->sealedConsumables(label);
+  BOOST_TEST_REQUIRE(sealed != nullptr);
+  std::vector<ProductTokenCache::Consumed> prefetched;
+  auto index = sealed->firstIndex[InEvent];
+  for (auto const& info : (*sealed->consumables)[InEvent]) {
+    prefetched.push_back({index++, info});
+  }
+
+  ModuleDescription const md{fhicl::ParameterSetID{},
+                             "Consumer",
+                             label,
+                             ModuleThreadingType::shared,
+                             current};
+  ModuleContext const mc{md};
+  auto const ep = make_principal();
+  GlobalTaskGroup task_group{4, 8 * 1024 * 1024};
+  unsigned reads_before_body{};
+  auto body = make_waiting_task<ModuleBodyTask>(*reader_, reads_before_body);
+  ep->prefetchAsync(mc, prefetched, body, task_group);
+  task_group.native_group().wait();
+
+  BOOST_TEST(reads_before_body == 2u);
+  for (auto const& tag : {"a"s, "b"s}) {
+    auto const qr = ep->getByProductID(pids_.at(tag));
+    BOOST_TEST_REQUIRE(qr.succeeded());
+    BOOST_TEST(qr.result()->anyProduct() != nullptr);
+  }
+  // The products were not read again when retrieved, and the product
+  // that is not consumed was never read.
+  BOOST_TEST(reader_->reads() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(secondary_file_read_once)
+{
+  SecondaryFileIndex::instance()->invalidate();
+  ProductTables const file0{ProductDescriptions{present_description("x")}};
+  ProductTables const file1{ProductDescriptions{present_description("y")}};
+  ProductTables const primary{ProductDescriptions{present_description("a")}};
+
+  EventAuxiliary aux{EventID{1, 1, 1}, Timestamp{1234567UL}, true};
+  aux.setProcessHistoryID(processHistoryID_);
+  std::vector<unsigned> reads(2);
+  auto const make_primary = [&](std::vector<ProductTables const*> files) {
+    reads.assign(2, 0u);
+    return std::make_unique<EventPrincipal>(
+      aux,
+      current,
+      &primary.get(InEvent),
+      std::make_unique<SecondaryFileReader>(aux, std::move(files), reads));
+  };
+  auto const& wrapped = WrappedTypeID::make<arttest::IntProduct>();
+  ProcessTag const processTag{"", current.processName()};
+  auto const input_tags = [&](EventPrincipal const& ep,
+                              std::string const& label) {
+    return ep.getInputTags(ModuleContext::invalid(),
+                           wrapped,
+                           ModuleLabelSelector{label},
+                           processTag);
+  };
+
+  // Only the second secondary file holds the first event, so it is
+  // read in turn after passing over the first.
+  {
+    auto const ep = make_primary({nullptr, &file1});
+    BOOST_TEST(input_tags(*ep, "y").size() == 1u);
+    BOOST_TEST(reads == (std::vector<unsigned>{0u, 1u}));
+  }
+
+  // For the next event, the product is looked up directly in the file
+  // in which it was found, and not in the first file.  When the first
+  // file is then read in turn, the second is not read again.
+  {
+    auto const ep = make_primary({&file0, &file1});
+    BOOST_TEST(input_tags(*ep, "y").size() == 1u);
+    BOOST_TEST(reads == (std::vector<unsigned>{0u, 1u}));
+    BOOST_TEST(input_tags(*ep, "z").empty());
+    BOOST_TEST(reads == (std::vector<unsigned>{1u, 1u}));
+    BOOST_TEST(input_tags(*ep, "x").size() == 1u);
+    BOOST_TEST(input_tags(*ep, "y").size() == 1u);
+    BOOST_TEST(reads == (std::vector<unsigned>{1u, 1u}));
+  }
+  SecondaryFileIndex::instance()->invalidate();
+}
+
+BOOST_AUTO_TEST_CASE(provenance_read_on_demand)
+{
+  // The third product comes from a file of the old format, whose
+  // status is unknown.
+  std::map<ProductID, ProductStatus> const statuses{
+    {pids_.at("a"), productstatus::present()},
+    {pids_.at("b"), productstatus::neverCreated()},
+    {pids_.at("c"), productstatus::unknown()}};
+  std::map<ProductID, ProductStatus> const expected{
+    {pids_.at("a"), productstatus::present()},
+    {pids_.at("b"), productstatus::neverCreated()},
+    {pids_.at("c"), productstatus::dummyToPreventDoubleCount()}};
+
+  EventAuxiliary aux{EventID{1, 1, 1}, Timestamp{1234567UL}, true};
+  aux.setProcessHistoryID(processHistoryID_);
+  // A reader that does not read provenance concurrently has it read
+  // when the principal is made, under the input source lock, as it
+  // always was; one that does has it read on first use.  Either way,
+  // the provenance and availability of the products are the same.
+  for (bool const concurrent : {false, true}) {
+    unsigned reads{};
+    auto const ep = std::make_unique<EventPrincipal>(
+      aux,
+      current,
+      &presentProducts_.get(InEvent),
+      std::make_unique<ProvenanceReader>(statuses, concurrent, reads));
+    BOOST_TEST(reads == (concurrent ? 0u : 1u));
+    for (auto const& [pid, status] : expected) {
+      auto const provenance = ep->provenanceOnFile(pid);
+      BOOST_TEST_REQUIRE(provenance != nullptr);
+      BOOST_TEST(provenance->productStatus() == status);
+      BOOST_TEST(ep->availableOnFile(pid) ==
+                 (status != productstatus::neverCreated()));
+    }
+    BOOST_TEST(reads == 1u);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (EventArena_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/EventArena.h"
+#include "art/Framework/Principal/EventArenaPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+using art::EventArena;
+using art::EventArenaPool;
+
+BOOST_AUTO_TEST_SUITE(EventArena_t)
+
+BOOST_AUTO_TEST_CASE(alignment)
+{
+  EventArena arena{256};
+  for (std::size_t const alignment : {1u, 8u, 16u, 64u}) {
+    auto const p =
+      reinterpret_cast<std::uintptr_t>(arena.allocate(3, alignment));
+    BOOST_TEST(p % alignment == 0u);
+  }
+  // Larger than a chunk.
+  auto const p = reinterpret_cast<std::uintptr_t>(arena.allocate(1000, 128));
+  BOOST_TEST(p % 128 == 0u);
+  BOOST_TEST(arena.bytesAllocated() == 1012u);
+}
+
+BOOST_AUTO_TEST_CASE(reset_reuses_memory)
+{
+  EventArena arena{1024};
+  std::pmr::vector<int> first{&arena};
+  first.assign(100, 1);
+  auto const capacity = arena.capacity();
+  auto const highWaterMark = arena.highWaterMark();
+  BOOST_TEST(capacity != 0u);
+  BOOST_TEST(highWaterMark >= 100 * sizeof(int));
+
+  first = std::pmr::vector<int>{&arena};
+  arena.reset();
+  BOOST_TEST(arena.bytesAllocated() == 0u);
+  std::pmr::vector<int> second{&arena};
+  second.assign(100, 2);
+  BOOST_TEST(arena.capacity() == capacity);
+  BOOST_TEST(arena.highWaterMark() == highWaterMark);
+}
+
+BOOST_AUTO_TEST_CASE(pool)
+{
+  auto pool = EventArenaPool::instance();
+  pool->setCapacity(1);
+  auto arena = pool->take();
+  auto const address = arena.get();
+  BOOST_TEST(arena->allocate(64) != nullptr);
+  pool->give(std::move(arena));
+  BOOST_TEST(pool->take().get() == address);
+  auto const stats = pool->statistics();
+  BOOST_TEST(stats.created == 1u);
+  BOOST_TEST(stats.reused == 1u);
+  BOOST_TEST(stats.highWaterMark == 64u);
+  pool->setCapacity(0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,9 +3,12 @@
 #include "boost/test/unit_test.hpp"
 
 #include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/Group.h"
+#include "art/Framework/Principal/GroupPool.h"
 #include "art/Framework/Principal/ProcessTag.h"
 #include "art/Framework/Principal/RunPrincipal.h"
 #include "art/Framework/Principal/Selector.h"
+#include "art/Framework/Principal/SelectorMatchCache.h"
 #include "art/Framework/Principal/SubRunPrincipal.h"
 #include "art/Persistency/Common/GroupQueryResult.h"
 #include "art/Persistency/Provenance/ModuleContext.h"
@@ -24,14 +27,18 @@
 #include "canvas/Persistency/Provenance/SubRunAuxiliary.h"
 #include "canvas/Persistency/Provenance/Timestamp.h"
 #include "canvas/Persistency/Provenance/TypeLabel.h"
+#include "canvas/Utilities/InputTag.h"
 #include "canvas/Utilities/TypeID.h"
 #include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/ParameterSetID.h"
 
 #include <exception>
 #include <map>
 #include <memory>
 #include <string>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 using namespace std;
 using namespace std::string_literals;
@@ -248,4 +255,188 @@ BOOST_AUTO_TEST_CASE(failgetManybyTypeTest)
   BOOST_TEST(query_results.empty());
 }
 
+BOOST_AUTO_TEST_CASE(recycledGroupsTest)
+{
+  // Once the pool is enabled, the groups of a released principal are
+  // reused by the next principal made from the same product tables.
+  art::GroupPool::instance()->setCapacity(1);
+  auto const rick = ptf().productIDs_.at("rick");
+  auto const group = pEvent_->getByProductID(rick).result();
+  BOOST_TEST_REQUIRE(group->anyProduct() != nullptr);
+
+  art::EventAuxiliary const eventAux{pEvent_->eventAux()};
+  auto const& process = pEvent_->processConfiguration();
+  pEvent_.reset();
+
+  auto next = std::make_unique<art::EventPrincipal>(eventAux, process, nullptr);
+  next->createGroupsForProducedProducts(ptf().producedProducts_);
+  next->enableLookupOfProducedProducts();
+  BOOST_TEST(next->size() == 5u);
+  auto const qr = next->getByProductID(rick);
+  BOOST_TEST_REQUIRE(qr.succeeded());
+  BOOST_TEST(qr.result().get() == group.get());
+  BOOST_TEST(group->anyProduct() == nullptr);
+
+  next.reset();
+  art::GroupPool::instance()->setCapacity(0);
+}
+
+BOOST_AUTO_TEST_CASE(groupLookupTest)
+{
+  // Split the products between the input file and this process.
+  auto const& all = ptf().producedProducts_.get(InEvent);
+  ProductDescriptions present;
+  ProductDescriptions produced;
+  for (auto const& [tag, pid] : ptf().productIDs_) {
+    auto pd = all.description(pid);
+    BOOST_TEST_REQUIRE(pd != nullptr);
+    if (tag == "user" || tag == "rick") {
+      produced.push_back(*pd);
+    } else {
+      present.push_back(*pd);
+    }
+  }
+  ProductTables const presentProducts{present};
+  ProductTables const producedProducts{produced};
+
+  auto const& process = pEvent_->processConfiguration();
+  auto const make_principal = [&] {
+    auto ep = std::make_unique<art::EventPrincipal>(
+      pEvent_->eventAux(), process, &presentProducts.get(InEvent));
+    ep->createGroupsForProducedProducts(producedProducts);
+    ep->enableLookupOfProducedProducts();
+    return ep;
+  };
+
+  // The groups of the products from the input file come first,
+  // followed by those of the products produced in this process, each
+  // in ProductID order.
+  std::vector<ProductID> expected;
+  for (auto const* table :
+       {&presentProducts.get(InEvent), &producedProducts.get(InEvent)}) {
+    for (auto const& pr : table->descriptions) {
+      expected.push_back(pr.first);
+    }
+  }
+
+  // The second principal is made from the same product tables, and
+  // shares their index with the first.
+  for (int i = 0; i != 2; ++i) {
+    auto const ep = make_principal();
+    BOOST_TEST_REQUIRE(ep->size() == 5u);
+    std::vector<ProductID> order;
+    for (auto const& [pid, group] : *ep) {
+      BOOST_TEST(group->productDescription().productID() == pid);
+      order.push_back(pid);
+    }
+    BOOST_TEST(order == expected);
+    for (auto const pid : expected) {
+      BOOST_TEST(ep->provenance(pid).productID() == pid);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(cachedSelectorMatchesTest)
+{
+  // Products made in this process by several modules, some of them
+  // with an instance name.
+  auto const& process = pEvent_->processConfiguration();
+  TypeID const dummyType{typeid(arttest::DummyProduct)};
+  std::vector<std::pair<std::string, std::string>> const labels{
+    {"a", ""}, {"a", "x"}, {"b", ""}, {"b", "x"}, {"c", "y"}};
+  ProductDescriptions descriptions;
+  for (auto const& [label, instance] : labels) {
+    descriptions.emplace_back(
+      InEvent,
+      TypeLabel{dummyType,
+                instance,
+                SupportsView<arttest::DummyProduct>::value,
+                false},
+      label,
+      fhicl::ParameterSetID{},
+      process);
+  }
+  ProductTables const producedProducts{descriptions};
+
+  // As when an input file is opened.
+  SelectorMatchCache::instance()->invalidate();
+
+  auto ep = std::make_unique<art::EventPrincipal>(
+    pEvent_->eventAux(), process, nullptr);
+  ep->createGroupsForProducedProducts(producedProducts);
+  ep->enableLookupOfProducedProducts();
+  ep->addToProcessHistory();
+  for (auto const& [pid, pd] : producedProducts.get(InEvent).descriptions) {
+    ep->put(pd,
+            std::make_unique<ProductProvenance const>(
+              pid, productstatus::present()),
+            std::make_unique<Wrapper<arttest::DummyProduct>>(
+              std::make_unique<arttest::DummyProduct>()),
+            std::make_unique<RangeSet>(RangeSet::invalid()));
+  }
+
+  // A selector with a cache key must find the same groups, in the same
+  // order, as one without, which is always matched product by
+  // product.  The second lookup is answered from the cache.
+  auto const& wrapped = art::WrappedTypeID::make<arttest::DummyProduct>();
+  ProcessTag const processTag{""s, process.processName()};
+  auto const check = [&](SelectorBase const& cached,
+                         SelectorBase const& uncached) {
+    BOOST_TEST_REQUIRE(!cached.cacheKey().empty());
+    BOOST_TEST_REQUIRE(uncached.cacheKey().empty());
+    auto const tags =
+      ep->getInputTags(invalid_module_context, wrapped, uncached, processTag);
+    auto const expected =
+      ep->getMany(invalid_module_context, wrapped, uncached, processTag);
+    BOOST_TEST_REQUIRE(expected.size() == tags.size());
+    for (int i = 0; i != 2; ++i) {
+      BOOST_TEST(ep->getInputTags(invalid_module_context,
+                                  wrapped,
+                                  cached,
+                                  processTag) == tags);
+      auto const results =
+        ep->getMany(invalid_module_context, wrapped, cached, processTag);
+      BOOST_TEST_REQUIRE(results.size() == expected.size());
+      for (std::size_t j = 0; j != results.size(); ++j) {
+        BOOST_TEST_REQUIRE(results[j].succeeded());
+        BOOST_TEST(results[j].result().get() == expected[j].result().get());
+      }
+    }
+    return tags.size();
+  };
+
+  BOOST_TEST(check(ModuleLabelSelector{"a"},
+                   SelectorByFunction{[](BranchDescription const& pd) {
+                                        return pd.moduleLabel() == "a";
+                                      },
+                                      "module label a"}) == 2u);
+  BOOST_TEST(check(ModuleLabelSelector{"b"} && ProductInstanceNameSelector{"x"},
+                   SelectorByFunction{[](BranchDescription const& pd) {
+                                        return pd.moduleLabel() == "b" &&
+                                               pd.productInstanceName() == "x";
+                                      },
+                                      "b:x"}) == 1u);
+  BOOST_TEST(
+    check(ModuleLabelSelector{"c"} || !ProductInstanceNameSelector{""},
+          SelectorByFunction{[](BranchDescription const& pd) {
+                               return pd.moduleLabel() == "c" ||
+                                      !pd.productInstanceName().empty();
+                             },
+                             "c or any instance"}) == 3u);
+  BOOST_TEST(
+    check(Selector{ModuleLabelSelector{"a"} || ModuleLabelSelector{"b"}},
+          SelectorByFunction{[](BranchDescription const& pd) {
+                               return pd.moduleLabel() != "c";
+                             },
+                             "a or b"}) == 4u);
+  BOOST_TEST(check(MatchAllSelector{},
+                   SelectorByFunction{[](BranchDescription const&) {
+                                        return true;
+                                      },
+                                      "all"}) == 5u);
+
+  ep.reset();
+  SelectorMatchCache::instance()->invalidate();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
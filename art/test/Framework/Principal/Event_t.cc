@@ -18,9 +18,12 @@
 
 #include "boost/test/unit_test.hpp"
 
+#include "art/Framework/Principal/ConsumesInfo.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/EventPrincipal.h"
 #include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/ProcessTag.h"
+#include "art/Framework/Principal/ProductInfo.h"
 #include "art/Framework/Principal/RunPrincipal.h"
 #include "art/Framework/Principal/Selector.h"
 #include "art/Framework/Principal/SubRunPrincipal.h"
@@ -503,6 +506,48 @@ BOOST_AUTO_TEST_CASE(getProductTokens)
   }
 }
 
+BOOST_AUTO_TEST_CASE(getByToken)
+{
+  addSourceProduct(product_with_value(1), "int1_tag", "int1");
+  addSourceProduct(product_with_value(100), "int1_tag_late", "int1");
+  currentEvent_.put(product_with_value(200), "int1");
+  detail::Producer::commit(currentEvent_);
+
+  auto const tokens = currentEvent_.getProductTokens<product_t>(
+    ProductInstanceNameSelector{"int1"});
+  BOOST_TEST_REQUIRE(!tokens.empty());
+
+  // Tokens are only resolved through the ProductTokenCache once the
+  // consumes statements have been sealed.
+  auto const& processName = processConfiguration_.processName();
+  ConsumesInfo::consumables_t::mapped_type consumables;
+  for (auto const& token : tokens) {
+    auto const& tag = token.inputTag();
+    consumables[InEvent].emplace_back(ProductInfo::ConsumableType::Product,
+                                      TypeID{typeid(product_t)},
+                                      tag.label(),
+                                      tag.instance(),
+                                      ProcessTag{tag.process(), processName});
+  }
+  sort(begin(consumables[InEvent]), end(consumables[InEvent]));
+  ConsumesInfo::instance()->collectConsumes(
+    currentModuleContext_.moduleLabel(), consumables);
+  ConsumesInfo::instance()->sealConsumes();
+  auto const e = principal_->makeEvent(currentModuleContext_);
+
+  // The second retrieval of each token uses the cached candidates.
+  for (int i{}; i < 2; ++i) {
+    for (auto const& token : tokens) {
+      auto const h1 = e.getHandle<product_t>(token.inputTag());
+      auto const h2 = e.getHandle(token);
+      BOOST_TEST_REQUIRE(static_cast<bool>(h1) == static_cast<bool>(h2));
+      if (h1) {
+        BOOST_TEST(h1->value == h2->value);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(getByInstanceName)
 {
   using handle_t = Handle<product_t>;
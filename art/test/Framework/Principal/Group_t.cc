@@ -0,0 +1,162 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (Group_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/Group.h"
+#include "art/Framework/Principal/NoDelayedReader.h"
+#include "art/test/TestObjects/ToyProducts.h"
+#include "canvas/Persistency/Common/Assns.h"
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/ProcessConfiguration.h"
+#include "canvas/Persistency/Provenance/ProductProvenance.h"
+#include "canvas/Persistency/Provenance/ProductStatus.h"
+#include "canvas/Persistency/Provenance/RangeSet.h"
+#include "canvas/Persistency/Provenance/TypeLabel.h"
+#include "canvas/Utilities/TypeID.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace art;
+
+namespace {
+  using assns_t = Assns<arttest::IntProduct, arttest::StringProduct>;
+  using partner_t = Assns<arttest::StringProduct, arttest::IntProduct>;
+
+  ProcessConfiguration const process{"TEST", {}, {}};
+
+  template <typename T>
+  BranchDescription
+  description()
+  {
+    return BranchDescription{InEvent,
+                             TypeLabel{TypeID{typeid(T)}, "", false, false},
+                             "producer",
+                             {},
+                             process};
+  }
+
+  // Makes a group holding a product that has been put, as
+  // Principal::put does.
+  template <typename T>
+  std::unique_ptr<Group>
+  put_group(DelayedReader* reader,
+            BranchDescription const& bd,
+            Group::grouptype const gt)
+  {
+    auto group = std::make_unique<Group>(
+      reader, bd, std::make_unique<RangeSet>(RangeSet::invalid()), gt);
+    group->setProductAndProvenance(
+      std::make_unique<ProductProvenance const>(
+        bd.productID(), productstatus::present(), std::vector<ProductID>{}),
+      std::make_unique<Wrapper<T>>(std::make_unique<T>()),
+      std::make_unique<RangeSet>(RangeSet::invalid()));
+    return group;
+  }
+
+  // Calls f concurrently from several threads, each returning the
+  // product it was given; all of them must have been given the same.
+  // Boost.Test assertions are not thread-safe, so they are only made
+  // once the threads have finished.
+  template <typename F>
+  void
+  test_same_product_from_all_threads(F f)
+  {
+    std::vector<EDProduct const*> results(8);
+    std::vector<std::thread> threads;
+    for (std::size_t i{}; i != results.size(); ++i) {
+      threads.emplace_back([&f, &results, i] {
+        for (int n{}; n != 1000; ++n) {
+          auto const product = f();
+          if (n == 0) {
+            results[i] = product;
+          } else if (product != results[i]) {
+            results[i] = nullptr;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    BOOST_TEST_REQUIRE(results[0] != nullptr);
+    for (auto const result : results) {
+      BOOST_TEST(result == results[0]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(Group_t)
+
+BOOST_AUTO_TEST_CASE(resolved_product)
+{
+  NoDelayedReader reader;
+  auto const bd = description<arttest::IntProduct>();
+  auto group =
+    put_group<arttest::IntProduct>(&reader, bd, Group::grouptype::normal);
+  TypeID const wrapper{typeid(Wrapper<arttest::IntProduct>)};
+
+  BOOST_TEST_REQUIRE(group->tryToResolveProduct(wrapper));
+  auto const product = group->uniqueProduct(wrapper);
+  BOOST_TEST_REQUIRE(product != nullptr);
+  test_same_product_from_all_threads([&group, &wrapper] {
+    return group->tryToResolveProduct(wrapper) ?
+             group->uniqueProduct(wrapper) :
+             nullptr;
+  });
+  BOOST_TEST(group->uniqueProduct(wrapper) == product);
+  BOOST_TEST(group->anyProduct() == product);
+}
+
+BOOST_AUTO_TEST_CASE(assns_partner_made_once)
+{
+  NoDelayedReader reader;
+  auto const bd = description<assns_t>();
+  auto group = put_group<assns_t>(&reader, bd, Group::grouptype::assns);
+  TypeID const wrapper{typeid(Wrapper<assns_t>)};
+  TypeID const partner{typeid(Wrapper<partner_t>)};
+
+  // The partner is only made when it is asked for.
+  BOOST_TEST_REQUIRE(group->tryToResolveProduct(wrapper));
+  auto const product = group->uniqueProduct(wrapper);
+  BOOST_TEST_REQUIRE(product != nullptr);
+  BOOST_TEST(group->uniqueProduct(partner) == nullptr);
+
+  BOOST_TEST_REQUIRE(group->tryToResolveProduct(partner));
+  auto const partner_product = group->uniqueProduct(partner);
+  BOOST_TEST_REQUIRE(partner_product != nullptr);
+  BOOST_TEST(partner_product != product);
+  BOOST_TEST(dynamic_cast<Wrapper<partner_t> const*>(partner_product) !=
+             nullptr);
+  BOOST_TEST(group->tryToResolveProduct(partner));
+  BOOST_TEST(group->uniqueProduct(partner) == partner_product);
+  BOOST_TEST(group->uniqueProduct(wrapper) == product);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_assns_partner_resolution)
+{
+  // The first threads make the partner under the lock; all of them
+  // must then be given that same partner, whether they take the lock
+  // or not.
+  NoDelayedReader reader;
+  auto const bd = description<assns_t>();
+  auto group = put_group<assns_t>(&reader, bd, Group::grouptype::assns);
+  TypeID const wrapper{typeid(Wrapper<assns_t>)};
+  TypeID const partner{typeid(Wrapper<partner_t>)};
+
+  test_same_product_from_all_threads([&group, &partner] {
+    return group->tryToResolveProduct(partner) ?
+             group->uniqueProduct(partner) :
+             nullptr;
+  });
+  test_same_product_from_all_threads([&group, &wrapper] {
+    return group->tryToResolveProduct(wrapper) ?
+             group->uniqueProduct(wrapper) :
+             nullptr;
+  });
+  BOOST_TEST(group->uniqueProduct(partner) != group->uniqueProduct(wrapper));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
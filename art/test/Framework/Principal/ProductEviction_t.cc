@@ -0,0 +1,270 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (ProductEviction_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/DelayedReader.h"
+#include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/Group.h"
+#include "art/Framework/Principal/ProcessTag.h"
+#include "art/Framework/Principal/ProductEviction.h"
+#include "art/Framework/Principal/ProductInfo.h"
+#include "art/test/TestObjects/ToyProducts.h"
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/EventAuxiliary.h"
+#include "canvas/Persistency/Provenance/ProcessConfiguration.h"
+#include "canvas/Persistency/Provenance/ProductProvenance.h"
+#include "canvas/Persistency/Provenance/ProductStatus.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
+#include "canvas/Persistency/Provenance/Timestamp.h"
+#include "canvas/Persistency/Provenance/TypeLabel.h"
+#include "canvas/Utilities/TypeID.h"
+#include "fhiclcpp/ParameterSetID.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace art;
+
+namespace {
+  ProcessConfiguration const early{"EARLY", {}, {}};
+  ProcessConfiguration const current{"CURRENT", {}, {}};
+
+  template <typename T>
+  BranchDescription
+  description(std::string const& label,
+              std::string const& instance = {},
+              bool const present = true)
+  {
+    TypeID const type{typeid(T)};
+    constexpr bool supports_view = SupportsView<T>::value;
+    if (present) {
+      return BranchDescription{InEvent,
+                               TypeLabel{type, instance, supports_view, label},
+                               label,
+                               fhicl::ParameterSetID{},
+                               early};
+    }
+    return BranchDescription{InEvent,
+                             TypeLabel{type, instance, supports_view, false},
+                             label,
+                             fhicl::ParameterSetID{},
+                             current};
+  }
+
+  template <typename T>
+  ProductInfo
+  consumes(ProductInfo::ConsumableType const type,
+           std::string const& label = {},
+           std::string const& instance = {},
+           std::string const& process = {})
+  {
+    return ProductInfo{type,
+                       TypeID{typeid(T)},
+                       label,
+                       instance,
+                       ProcessTag{process, current.processName()}};
+  }
+
+  constexpr auto product = ProductInfo::ConsumableType::Product;
+  constexpr auto many = ProductInfo::ConsumableType::Many;
+  constexpr auto view = ProductInfo::ConsumableType::ViewElement;
+
+  // The consumers are registered once, as the PathManager does for
+  // the modules of the job.
+  struct Consumers {
+    Consumers();
+    std::size_t byLabel;
+    std::size_t byFullTag;
+    std::size_t byType;
+    std::size_t byView;
+    std::size_t ofKeptOrProduced;
+    std::size_t ofOtherProcess;
+  };
+
+  Consumers::Consumers()
+  {
+    auto eviction = ProductEviction::instance();
+    using arttest::IntProduct;
+    using arttest::StringProduct;
+    byLabel = eviction->addConsumer({consumes<IntProduct>(product, "a")});
+    byFullTag = eviction->addConsumer(
+      {consumes<IntProduct>(product, "b", "i", "EARLY"),
+       consumes<StringProduct>(product, "a")});
+    byType = eviction->addConsumer({consumes<IntProduct>(many)});
+    byView = eviction->addConsumer({consumes<int>(view, "v")});
+    ofKeptOrProduced = eviction->addConsumer(
+      {consumes<IntProduct>(product, "kept"),
+       consumes<IntProduct>(product, "p")});
+    ofOtherProcess =
+      eviction->addConsumer({consumes<IntProduct>(product, "a", "", "OTHER")});
+    // The products of module "kept" are written by an output module.
+    eviction->addOutputSelection([](BranchDescription const& pd) {
+      return pd.moduleLabel() == "kept";
+    });
+  }
+
+  Consumers const&
+  consumers()
+  {
+    static Consumers const consumers_s;
+    return consumers_s;
+  }
+
+  // Reads each product anew, counting the reads.
+  class CountingReader : public DelayedReader {
+  public:
+    explicit CountingReader(std::vector<ProductID> pids)
+      : pids_{std::move(pids)}
+    {}
+
+    unsigned
+    reads() const
+    {
+      return reads_;
+    }
+
+  private:
+    std::unique_ptr<EDProduct>
+    getProduct_(Group const*, ProductID, RangeSet&) const override
+    {
+      ++reads_;
+      return std::make_unique<Wrapper<arttest::IntProduct>>(
+        std::make_unique<arttest::IntProduct>());
+    }
+
+    std::vector<ProductProvenance>
+    readProvenance_() const override
+    {
+      std::vector<ProductProvenance> result;
+      for (auto const pid : pids_) {
+        result.emplace_back(pid, productstatus::present());
+      }
+      return result;
+    }
+
+    std::vector<ProductID> pids_;
+    mutable unsigned reads_{};
+  };
+}
+
+BOOST_AUTO_TEST_SUITE(ProductEviction_t)
+
+BOOST_AUTO_TEST_CASE(plan)
+{
+  auto const& c = consumers();
+  std::map<std::string, ProductID> pids;
+  ProductDescriptions descriptions;
+  auto add = [&pids, &descriptions](std::string const& name,
+                                    BranchDescription const& pd) {
+    pids.emplace(name, pd.productID());
+    descriptions.push_back(pd);
+  };
+  add("a", description<arttest::IntProduct>("a"));
+  add("b", description<arttest::IntProduct>("b", "i"));
+  add("s", description<arttest::StringProduct>("s"));
+  add("v", description<std::vector<int>>("v"));
+  add("kept", description<arttest::IntProduct>("kept"));
+  add("p", description<arttest::IntProduct>("p", "", false));
+  ProductTables const tables{descriptions};
+
+  auto eviction = ProductEviction::instance();
+  eviction->invalidate();
+  auto const plan = eviction->plan(tables.get(InEvent));
+  BOOST_TEST(plan == eviction->plan(tables.get(InEvent)));
+
+  // Products that are written, produced in this process, or consumed
+  // by no module are not in the plan.
+  std::map<std::string, std::size_t> positions;
+  for (auto const& [name, pid] : pids) {
+    auto it = std::find(plan->products.cbegin(), plan->products.cend(), pid);
+    if (it != plan->products.cend()) {
+      positions.emplace(name, it - plan->products.cbegin());
+    }
+  }
+  BOOST_TEST_REQUIRE(positions.size() == 3u);
+  auto const a = positions.at("a");
+  auto const b = positions.at("b");
+  auto const v = positions.at("v");
+  BOOST_TEST(plan->consumerCounts[a] == 2u);
+  BOOST_TEST(plan->consumerCounts[b] == 2u);
+  BOOST_TEST(plan->consumerCounts[v] == 1u);
+
+  using positions_t = std::vector<std::size_t>;
+  BOOST_TEST_REQUIRE(plan->consumed.size() == c.ofOtherProcess + 1);
+  BOOST_TEST(plan->consumed[c.byLabel] == positions_t{a});
+  BOOST_TEST(plan->consumed[c.byFullTag] == positions_t{b});
+  BOOST_TEST(plan->consumed[c.byType] ==
+             (a < b ? positions_t{a, b} : positions_t{b, a}));
+  BOOST_TEST(plan->consumed[c.byView] == positions_t{v});
+  BOOST_TEST(plan->consumed[c.ofKeptOrProduced].empty());
+  BOOST_TEST(plan->consumed[c.ofOtherProcess].empty());
+}
+
+BOOST_AUTO_TEST_CASE(consumer_done)
+{
+  auto const& c = consumers();
+  ProductDescriptions descriptions;
+  for (auto const& label : {"a", "v"}) {
+    descriptions.push_back(description<arttest::IntProduct>(label));
+  }
+  descriptions.push_back(description<arttest::IntProduct>("b", "i"));
+  ProductTables const tables{descriptions};
+  std::vector<ProductID> pids;
+  for (auto const& pd : descriptions) {
+    pids.push_back(pd.productID());
+  }
+  auto const a = pids[0];
+  auto const b = pids[2];
+
+  auto eviction = ProductEviction::instance();
+  eviction->invalidate();
+  auto reader = std::make_unique<CountingReader>(pids);
+  auto const& counting = *reader;
+  EventAuxiliary const aux{EventID{1, 1, 1}, Timestamp{1234567UL}, true};
+  EventPrincipal const ep{
+    aux, current, &tables.get(InEvent), std::move(reader)};
+  auto product_of = [&ep](ProductID const pid) {
+    auto const qr = ep.getByProductID(pid);
+    BOOST_TEST_REQUIRE(qr.succeeded());
+    return qr.result()->anyProduct();
+  };
+  for (auto const pid : {a, b}) {
+    BOOST_TEST_REQUIRE(ep.getByProductID(pid).result()->tryToResolveProduct(
+      TypeID{typeid(Wrapper<arttest::IntProduct>)}));
+  }
+  BOOST_TEST_REQUIRE(counting.reads() == 2u);
+  auto const evictions = eviction->evictions();
+
+  // Each product is evicted once its last consumer is done.
+  ep.consumerDone(c.byLabel);
+  ep.consumerDone(c.byFullTag);
+  BOOST_TEST(product_of(a) != nullptr);
+  BOOST_TEST(product_of(b) != nullptr);
+  BOOST_TEST(eviction->evictions() == evictions);
+  ep.consumerDone(c.byType);
+  BOOST_TEST(product_of(a) == nullptr);
+  BOOST_TEST(product_of(b) == nullptr);
+  BOOST_TEST(eviction->evictions() == evictions + 2);
+
+  // A product that was never read is not counted as evicted.
+  ep.consumerDone(c.byView);
+  BOOST_TEST(eviction->evictions() == evictions + 2);
+
+  // Consumers that consume nothing of the file, or that were added
+  // after the plan was made, evict nothing.
+  ep.consumerDone(c.ofKeptOrProduced);
+  ep.consumerDone(c.ofOtherProcess + 1);
+  BOOST_TEST(eviction->evictions() == evictions + 2);
+
+  // An evicted product is read again when it is retrieved.
+  BOOST_TEST(ep.getByProductID(a).result()->tryToResolveProduct(
+    TypeID{typeid(Wrapper<arttest::IntProduct>)}));
+  BOOST_TEST(counting.reads() == 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,209 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (ProductInserter_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/EventPrincipal.h"
+#include "art/Framework/Principal/Group.h"
+#include "art/Framework/Principal/ProductInserter.h"
+#include "art/Persistency/Common/GroupQueryResult.h"
+#include "art/Persistency/Provenance/ModuleContext.h"
+#include "art/Persistency/Provenance/ModuleDescription.h"
+#include "art/Persistency/Provenance/ModuleType.h"
+#include "art/Persistency/Provenance/ProductSlotLayout.h"
+#include "art/test/TestObjects/ToyProducts.h"
+#include "canvas/Persistency/Common/Assns.h"
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "canvas/Persistency/Common/traits.h"
+#include "canvas/Persistency/Provenance/BranchDescription.h"
+#include "canvas/Persistency/Provenance/EventAuxiliary.h"
+#include "canvas/Persistency/Provenance/ProcessConfiguration.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
+#include "canvas/Persistency/Provenance/Timestamp.h"
+#include "canvas/Persistency/Provenance/TypeLabel.h"
+#include "canvas/Utilities/Exception.h"
+#include "canvas/Utilities/TypeID.h"
+#include "fhiclcpp/ParameterSetID.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace art;
+
+namespace {
+  using assns_t = Assns<arttest::IntProduct, arttest::StringProduct>;
+  using reversed_assns_t = Assns<arttest::StringProduct, arttest::IntProduct>;
+
+  ProcessConfiguration const current{"CURRENT", {}, {}};
+
+  template <typename T>
+  TypeLabel
+  type_label(std::string const& instance)
+  {
+    return TypeLabel{
+      TypeID{typeid(T)}, instance, SupportsView<T>::value, false};
+  }
+
+  auto
+  has_category(errors::ErrorCodes const category)
+  {
+    return [category](Exception const& e) {
+      return e.categoryCode() == category;
+    };
+  }
+
+  struct InserterFixture {
+    InserterFixture();
+
+    template <typename T>
+    void declare(std::string const& instance);
+    std::unique_ptr<EventPrincipal> make_principal() const;
+
+    ModuleDescription const md_{fhicl::ParameterSetID{},
+                                "Producer",
+                                "producer",
+                                ModuleThreadingType::shared,
+                                current};
+    std::map<TypeLabel, BranchDescription> expected_{};
+    ProductDescriptions descriptions_{};
+    ProductTables producedProducts_{ProductTables::invalid()};
+
+    // The products are laid out either when they are registered, or,
+    // for a context without a layout, by the inserter.
+    std::vector<ModuleContext> contexts_{};
+  };
+
+  InserterFixture::InserterFixture()
+  {
+    declare<arttest::IntProduct>("");
+    declare<arttest::IntProduct>("other");
+    declare<assns_t>("");
+    // A product of another module in the same process.
+    descriptions_.emplace_back(InEvent,
+                               type_label<arttest::IntProduct>(""),
+                               "another",
+                               fhicl::ParameterSetID{},
+                               current);
+    producedProducts_ = ProductTables{descriptions_};
+
+    ProductDescriptions registered;
+    for (auto const& [label, pd] : expected_) {
+      registered.push_back(pd);
+    }
+    contexts_.emplace_back(
+      md_, std::make_shared<ProductSlotLayout const>(std::move(registered)));
+    contexts_.emplace_back(md_);
+  }
+
+  template <typename T>
+  void
+  InserterFixture::declare(std::string const& instance)
+  {
+    auto const label = type_label<T>(instance);
+    auto const [it, inserted] = expected_.try_emplace(label,
+                                                      InEvent,
+                                                      label,
+                                                      md_.moduleLabel(),
+                                                      fhicl::ParameterSetID{},
+                                                      current);
+    BOOST_TEST_REQUIRE(inserted);
+    descriptions_.push_back(it->second);
+  }
+
+  std::unique_ptr<EventPrincipal>
+  InserterFixture::make_principal() const
+  {
+    EventAuxiliary const aux{EventID{1, 1, 1}, Timestamp{1234567UL}, true};
+    auto ep = std::make_unique<EventPrincipal>(aux, current, nullptr);
+    ep->createGroupsForProducedProducts(producedProducts_);
+    ep->enableLookupOfProducedProducts();
+    return ep;
+  }
+}
+
+BOOST_FIXTURE_TEST_SUITE(ProductInserter_t, InserterFixture)
+
+BOOST_AUTO_TEST_CASE(put_and_commit)
+{
+  for (auto const& mc : contexts_) {
+    auto const ep = make_principal();
+    ProductInserter inserter{InEvent, *ep, mc};
+    std::vector<ProductID> const pids{
+      inserter.put(std::make_unique<arttest::IntProduct>(1)).id(),
+      inserter.put(std::make_unique<arttest::IntProduct>(2), "other").id(),
+      inserter.put(std::make_unique<assns_t>()).id()};
+    inserter.commitProducts(true, &expected_, {});
+    for (auto const pid : pids) {
+      auto const qr = ep->getByProductID(pid);
+      BOOST_TEST_REQUIRE(qr.succeeded());
+      BOOST_TEST(qr.result()->anyProduct() != nullptr);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_put)
+{
+  for (auto const& mc : contexts_) {
+    auto const ep = make_principal();
+    ProductInserter inserter{InEvent, *ep, mc};
+    auto const pid =
+      inserter.put(std::make_unique<arttest::IntProduct>(1)).id();
+    BOOST_CHECK_EXCEPTION(
+      inserter.put(std::make_unique<arttest::IntProduct>(2)),
+      Exception,
+      has_category(errors::ProductPutFailure));
+    // The first product is kept.
+    inserter.commitProducts();
+    auto const qr = ep->getByProductID(pid);
+    BOOST_TEST_REQUIRE(qr.succeeded());
+    auto const product =
+      dynamic_cast<Wrapper<arttest::IntProduct> const*>(
+        qr.result()->anyProduct());
+    BOOST_TEST_REQUIRE(product != nullptr);
+    BOOST_TEST(product->product()->value == 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(missing_product)
+{
+  for (auto const& mc : contexts_) {
+    auto const ep = make_principal();
+    ProductInserter inserter{InEvent, *ep, mc};
+    // Neither a product that was not declared, nor one declared by
+    // another module, may be put.
+    BOOST_CHECK_EXCEPTION(
+      inserter.put(std::make_unique<arttest::IntProduct>(1), "undeclared"),
+      Exception,
+      has_category(errors::ProductRegistrationFailure));
+    inserter.put(std::make_unique<arttest::IntProduct>(1));
+    inserter.put(std::make_unique<assns_t>());
+    BOOST_CHECK_EXCEPTION(inserter.commitProducts(true, &expected_, {}),
+                          Exception,
+                          has_category(errors::LogicError));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(assns_order)
+{
+  // Assns(A,B) and Assns(B,A) have the same ProductID; only the
+  // declared one may be put.
+  BOOST_TEST(TypeID{typeid(assns_t)}.friendlyClassName() ==
+             TypeID{typeid(reversed_assns_t)}.friendlyClassName());
+  for (auto const& mc : contexts_) {
+    auto const ep = make_principal();
+    ProductInserter inserter{InEvent, *ep, mc};
+    BOOST_CHECK_EXCEPTION(inserter.put(std::make_unique<reversed_assns_t>()),
+                          Exception,
+                          has_category(errors::ProductRegistrationFailure));
+    auto const pid = inserter.put(std::make_unique<assns_t>()).id();
+    inserter.commitProducts();
+    auto const qr = ep->getByProductID(pid);
+    BOOST_TEST_REQUIRE(qr.succeeded());
+    BOOST_TEST(qr.result()->productDescription().producedClassName() ==
+               TypeID{typeid(assns_t)}.className());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
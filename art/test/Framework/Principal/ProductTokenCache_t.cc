@@ -0,0 +1,113 @@
+// vim: set sw=2 expandtab :
+#define BOOST_TEST_MODULE (ProductTokenCache_t)
+#include "boost/test/unit_test.hpp"
+
+#include "art/Framework/Principal/ConsumesInfo.h"
+#include "art/Framework/Principal/ProcessTag.h"
+#include "art/Framework/Principal/ProductInfo.h"
+#include "art/Framework/Principal/ProductTokenCache.h"
+#include "canvas/Persistency/Provenance/ProcessHistory.h"
+#include "canvas/Persistency/Provenance/ProductTables.h"
+#include "canvas/Utilities/TypeID.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace art;
+
+namespace {
+  ProductInfo
+  declared(std::string const& label)
+  {
+    return ProductInfo{ProductInfo::ConsumableType::Product,
+                       TypeID{typeid(int)},
+                       label,
+                       "",
+                       ProcessTag{"", "CURRENT"}};
+  }
+
+  // Seals the consumes statements of two modules, three in all.
+  void
+  seal_consumes()
+  {
+    auto consumes = ConsumesInfo::instance();
+    ConsumesInfo::consumables_t::mapped_type a;
+    a[InEvent] = {declared("x"), declared("y")};
+    std::sort(begin(a[InEvent]), end(a[InEvent]));
+    consumes->collectConsumes("a", a);
+    ConsumesInfo::consumables_t::mapped_type b;
+    b[InEvent] = {declared("x")};
+    consumes->collectConsumes("b", b);
+    consumes->sealConsumes();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(ProductTokenCache_t)
+
+BOOST_AUTO_TEST_CASE(resolutions_are_shared_per_tables)
+{
+  seal_consumes();
+  BOOST_TEST_REQUIRE(ConsumesInfo::instance()->numConsumables() == 3u);
+  auto cache = ProductTokenCache::instance();
+  ProductTable const present{};
+  ProductTable const other{};
+  ProcessHistoryID const phid{};
+  ProcessHistory history;
+  history.push_back(ProcessConfiguration{"EARLY", {}, {}});
+  auto const otherID = history.id();
+
+  auto r1 = cache->resolutions({&present, nullptr, phid});
+  auto r2 = cache->resolutions({&present, nullptr, phid});
+  BOOST_TEST(r1 == r2);
+  BOOST_TEST(r1 != cache->resolutions({&other, nullptr, phid}));
+  BOOST_TEST(r1 != cache->resolutions({&present, &other, phid}));
+  BOOST_TEST(r1 != cache->resolutions({&present, nullptr, otherID}));
+
+  // A principal that still holds the old object may keep using it.
+  cache->invalidate();
+  auto r3 = cache->resolutions({&present, nullptr, phid});
+  BOOST_TEST(r1 != r3);
+  BOOST_TEST(r1->find(0) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(first_insertion_wins)
+{
+  ProductTokenCache::Resolutions resolutions{3};
+  for (std::size_t i{}; i != 3; ++i) {
+    BOOST_TEST(resolutions.find(i) == nullptr);
+  }
+  ProductID const pid{42};
+  auto const& inserted = resolutions.insert(1, {{7, pid}});
+  BOOST_TEST(resolutions.find(1) == &inserted);
+  BOOST_TEST(resolutions.find(0) == nullptr);
+  BOOST_TEST(resolutions.find(2) == nullptr);
+
+  auto const& again = resolutions.insert(1, {});
+  BOOST_TEST(&again == &inserted);
+  BOOST_TEST_REQUIRE(again.size() == 1u);
+  BOOST_TEST(again[0].index == 7u);
+  BOOST_TEST(again[0].pid == pid);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_insertions)
+{
+  ProductTokenCache::Resolutions resolutions{1};
+  std::vector<ProductTokenCache::Candidates const*> results(8);
+  std::vector<std::thread> threads;
+  for (std::size_t i{}; i != results.size(); ++i) {
+    threads.emplace_back([&resolutions, &results, i] {
+      ProductTokenCache::Candidates candidates{{i, ProductID{}}};
+      results[i] = &resolutions.insert(0, std::move(candidates));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto const result : results) {
+    BOOST_TEST(result == resolutions.find(0));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -30,4 +30,25 @@ BOOST_AUTO_TEST_CASE(composed_selector_with_not_rvalue)
                      !ModuleLabelSelector{"moduleLabel"}};
 }
 
+BOOST_AUTO_TEST_CASE(cache_keys)
+{
+  ModuleLabelSelector const label{"label"};
+  ProductInstanceNameSelector const instance{"instance"};
+  BOOST_TEST(Selector{label && instance}.cacheKey() ==
+             (label && instance).cacheKey());
+  BOOST_TEST(label.cacheKey() != ModuleLabelSelector{"other"}.cacheKey());
+  BOOST_TEST(label.cacheKey() !=
+             ProductInstanceNameSelector{"label"}.cacheKey());
+  BOOST_TEST((label && instance).cacheKey() != (label || instance).cacheKey());
+  BOOST_TEST((!label).cacheKey() != label.cacheKey());
+  BOOST_TEST(!MatchAllSelector{}.cacheKey().empty());
+
+  // Selectors calling user code are never cached.
+  SelectorByFunction const by_function{
+    [](BranchDescription const&) { return true; }, "all"};
+  BOOST_TEST(by_function.cacheKey().empty());
+  BOOST_TEST((label && by_function).cacheKey().empty());
+  BOOST_TEST(Selector{!by_function}.cacheKey().empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()